@@ -0,0 +1,242 @@
+// Micro-benchmark từng thành phần với input tổng hợp, xác định (seed cố định), không cần file dữ liệu.
+// Forward YOLO chỉ chạy khi có model (mặc định Config::MODEL_PATH, hoặc --model <path>).
+//
+//   ./PickleballBench [--model data/model_ver2.onnx] [--filter tracker]
+
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "Config.h"
+#include "YoloDetector.h"
+#include "YoloDecoder.h"
+#include "BallTracker.h"
+#include "ColorStats.h"
+#include "LineDetector.h"
+#include "KalmanFilter.h"
+#include "KalmanBank.h"
+#include "CourtTiling.h"
+
+static volatile double g_sink = 0.0; // Giữ kết quả để compiler không bỏ code được đo
+static std::string g_filter;
+
+// Chạy fn iterations lần (sau warmup), in median / p95 / min / mean theo microsecond
+template <typename Fn>
+static void bench(const std::string& name, int iterations, Fn&& fn) {
+    if (!g_filter.empty() && name.find(g_filter) == std::string::npos) return;
+
+    int warmup = std::max(1, iterations / 10);
+    for (int i = 0; i < warmup; ++i) fn();
+
+    std::vector<double> samples(iterations);
+    for (int i = 0; i < iterations; ++i) {
+        auto t0 = std::chrono::steady_clock::now();
+        fn();
+        auto t1 = std::chrono::steady_clock::now();
+        samples[i] = std::chrono::duration<double, std::micro>(t1 - t0).count();
+    }
+    double mean = 0.0;
+    for (double s : samples) mean += s;
+    mean /= iterations;
+    std::sort(samples.begin(), samples.end());
+    double median = samples[iterations / 2];
+    double p95 = samples[std::min(iterations - 1, (int)(iterations * 0.95))];
+    std::printf("%-40s %8d %12.2f %12.2f %12.2f %12.2f\n", name.c_str(), iterations,
+                median, p95, samples.front(), mean);
+}
+
+// Frame giả lập sân: nền xanh có nhiễu, đường biên trắng, vài vệt tối (bóng đổ) và bóng vàng
+static cv::Mat makeCourtFrame(cv::Size size, uint64_t seed) {
+    cv::RNG rng(seed);
+    cv::Mat frame(size, CV_8UC3, cv::Scalar(70, 130, 60));
+    cv::Mat noise(size, CV_8UC3);
+    rng.fill(noise, cv::RNG::UNIFORM, cv::Scalar(0, 0, 0), cv::Scalar(25, 25, 25));
+    frame += noise;
+
+    float sx = size.width / 1920.0f;
+    float sy = size.height / 1080.0f;
+    int thickness = std::max(3, (int)(8 * sx));
+    cv::Scalar white(235, 235, 235);
+    cv::line(frame, cv::Point(300 * sx, 950 * sy), cv::Point(1620 * sx, 950 * sy), white, thickness);
+    cv::line(frame, cv::Point(520 * sx, 300 * sy), cv::Point(1400 * sx, 300 * sy), white, thickness);
+    cv::line(frame, cv::Point(300 * sx, 950 * sy), cv::Point(520 * sx, 300 * sy), white, thickness);
+    cv::line(frame, cv::Point(1620 * sx, 950 * sy), cv::Point(1400 * sx, 300 * sy), white, thickness);
+    cv::line(frame, cv::Point(960 * sx, 300 * sy), cv::Point(960 * sx, 950 * sy), white, thickness);
+
+    for (int i = 0; i < 20; ++i) {
+        cv::Point c(rng.uniform(0, size.width), rng.uniform(0, size.height));
+        cv::circle(frame, c, rng.uniform(8, 30), cv::Scalar(20, 25, 20), -1);
+        cv::Point b(rng.uniform(0, size.width), rng.uniform(0, size.height));
+        cv::circle(frame, b, rng.uniform(5, 12), cv::Scalar(40, 230, 240), -1);
+    }
+    return frame;
+}
+
+// Chuỗi frame detection: 1 bóng bay theo parabol + (count - 1) box nhiễu ngẫu nhiên
+static std::vector<std::vector<cv::Rect>> makeDetectionSequence(int count, int frames, cv::Size size, uint64_t seed) {
+    cv::RNG rng(seed);
+    std::vector<std::vector<cv::Rect>> seq(frames);
+    for (int f = 0; f < frames; ++f) {
+        float t = (float)(f % 60);
+        float x = 200.0f + 25.0f * t;
+        float y = 300.0f + (t - 30.0f) * (t - 30.0f) * 0.5f;
+        seq[f].push_back(cv::Rect((int)x - 8, (int)y - 8, 16, 16));
+        for (int i = 1; i < count; ++i) {
+            int w = rng.uniform(8, 40);
+            seq[f].push_back(cv::Rect(rng.uniform(0, size.width - w), rng.uniform(0, size.height - w), w, w));
+        }
+    }
+    return seq;
+}
+
+// Output YOLO giả [1, 4 + NUM_CLASSES, 8400]: phần lớn score thấp, vài cụm anchor vượt ngưỡng
+static cv::Mat makeYoloOutput(int channels, int anchors, uint64_t seed) {
+    cv::RNG rng(seed);
+    int sz[] = {1, channels, anchors};
+    cv::Mat out(3, sz, CV_32F);
+    float* data = out.ptr<float>();
+    for (int a = 0; a < anchors; ++a) {
+        data[a] = rng.uniform(0.0f, 640.0f);
+        data[anchors + a] = rng.uniform(0.0f, 640.0f);
+        data[2 * anchors + a] = rng.uniform(5.0f, 30.0f);
+        data[3 * anchors + a] = rng.uniform(5.0f, 30.0f);
+        for (int c = 4; c < channels; ++c) data[c * anchors + a] = rng.uniform(0.0f, 0.1f);
+    }
+    for (int k = 0; k < 30; ++k) {
+        int a = rng.uniform(0, anchors);
+        data[4 * anchors + a] = rng.uniform(0.3f, 0.95f);
+    }
+    return out;
+}
+
+static bool fileExists(const std::string& path) {
+    std::ifstream f(path);
+    return f.good();
+}
+
+int main(int argc, char** argv) {
+    std::string modelPath = Config::MODEL_PATH;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--model" && i + 1 < argc) modelPath = argv[++i];
+        else if (arg == "--filter" && i + 1 < argc) g_filter = argv[++i];
+    }
+
+    std::printf("%-40s %8s %12s %12s %12s %12s\n", "benchmark (us/op)", "iters", "median", "p95", "min", "mean");
+
+    const cv::Size hd(1920, 1080);
+    cv::Mat frame = makeCourtFrame(hd, 1);
+
+    // --- YOLO: preprocess / forward / decode ---
+    cv::Mat blob;
+    bench("yolo/preprocess 1080p->640", 50, [&]() {
+        YoloDetector::preprocess(frame, blob, 640);
+        g_sink = g_sink + blob.total();
+    });
+    if (fileExists(modelPath)) {
+        YoloDetector detector(modelPath);
+        YoloDetector::preprocess(frame, blob, 640);
+        cv::Mat output;
+        bench("yolo/forward 640", 10, [&]() {
+            output = detector.forward(blob);
+            g_sink = g_sink + output.total();
+        });
+        bench("yolo/decode (model output)", 200, [&]() {
+            g_sink = g_sink + detector.decode(output, cv::Rect(0, 0, frame.cols, frame.rows), 640).size();
+        });
+
+        // 4K: ép cả frame vào 640 so với tile letterbox trên vùng sân
+        cv::Mat frame4k = makeCourtFrame(cv::Size(3840, 2160), 6);
+        std::vector<Detection> dets;
+        bench("yolo/detect 4K full frame", 5, [&]() {
+            detector.detect(frame4k, dets);
+            g_sink = g_sink + dets.size();
+        });
+        std::vector<cv::Rect> tiles = CourtTiling::layout(
+            CourtTiling::courtRegion(LineDetector().detect(frame4k), frame4k.size()), Config::TILE_SIZE, Config::TILE_OVERLAP);
+        bench("yolo/detect 4K court tiles (" + std::to_string(tiles.size()) + ")", 5, [&]() {
+            detector.detectTiles(frame4k, tiles, dets);
+            g_sink = g_sink + dets.size();
+        });
+    } else {
+        std::printf("%-40s skipped (model not found: %s)\n", "yolo/forward 640", modelPath.c_str());
+    }
+    {
+        const int anchors = 8400;
+        cv::Mat output = makeYoloOutput(4 + Config::NUM_CLASSES, anchors, 2);
+        YoloDecoder decoder;
+        DecodeParams params;
+        params.confThreshold = Config::CONF_THRESHOLD;
+        params.scoreThreshold = Config::SCORE_THRESHOLD;
+        params.nmsThreshold = Config::NMS_THRESHOLD;
+        params.scaleX = frame.cols / 640.0f;
+        params.scaleY = frame.rows / 640.0f;
+        params.offsetX = 0.0f;
+        params.offsetY = 0.0f;
+        std::vector<Detection> dets;
+        bench("yolo/decode synthetic 8400", 2000, [&]() {
+            decoder.decode<Config::NUM_CLASSES>(output.ptr<float>(), anchors, params, dets);
+            g_sink = g_sink + dets.size();
+        });
+    }
+
+    // --- BallTracker::update ---
+    for (int count : {1, 10, 100, 1000}) {
+        auto seq = makeDetectionSequence(count, 120, hd, 3 + count);
+        BallTracker tracker;
+        TrackResult result;
+        size_t f = 0;
+        bench("tracker/update " + std::to_string(count) + " dets", count >= 1000 ? 100 : 500, [&]() {
+            g_sink = g_sink + tracker.update(seq[f], frame, result);
+            f = (f + 1) % seq.size();
+        });
+    }
+
+    // --- Lọc màu: isBlackOrGray / computeBrightness ---
+    for (int side : {8, 16, 32, 64, 128}) {
+        cv::Rect box(900, 500, side, side);
+        bench("color/filter roi " + std::to_string(side) + "x" + std::to_string(side), 5000, [&]() {
+            ColorStats::RoiStats stats = ColorStats::compute(frame, box);
+            g_sink = g_sink + BallTracker::isBlackOrGray(stats) + BallTracker::computeBrightness(stats);
+        });
+    }
+
+    // --- LineDetector::detect ---
+    LineDetector lineDetector;
+    const std::pair<const char*, cv::Size> resolutions[] = {
+        {"720p", cv::Size(1280, 720)}, {"1080p", cv::Size(1920, 1080)}, {"4K", cv::Size(3840, 2160)}};
+    for (const auto& res : resolutions) {
+        cv::Mat court = makeCourtFrame(res.second, 4);
+        bench(std::string("line/detect ") + res.first, 20, [&]() {
+            g_sink = g_sink + lineDetector.detect(court).size();
+        });
+    }
+
+    // --- Kalman ---
+    {
+        KalmanWrapper kf;
+        int step = 0;
+        bench("kalman/wrapper update", 100000, [&]() {
+            cv::Point2f p = kf.update(100.0f + step, 200.0f + 0.5f * step);
+            g_sink = g_sink + p.x;
+            step = (step + 1) % 1000;
+        });
+    }
+    {
+        KalmanBank<Config::MAX_TRACKS> bank(Config::PROCESS_NOISE, Config::MEASUREMENT_NOISE);
+        for (int i = 0; i < Config::MAX_TRACKS; ++i) bank.init(i, 10.0f * i, 5.0f * i);
+        int step = 0;
+        bench("kalman/bank predict+correct " + std::to_string(Config::MAX_TRACKS), 20000, [&]() {
+            bank.predictAll();
+            for (int i = 0; i < Config::MAX_TRACKS; i += 2) bank.measure(i, 10.0f * i + step, 5.0f * i);
+            bank.correctAll();
+            g_sink = g_sink + bank.position(0).x;
+            step = (step + 1) % 1000;
+        });
+    }
+
+    return 0;
+}
@@ -0,0 +1,128 @@
+#ifndef ANALYSIS_SESSION_H
+#define ANALYSIS_SESSION_H
+
+#include <opencv2/opencv.hpp>
+#include <functional>
+#include <vector>
+#include "ModelPool.h"
+#include "ColorStats.h"
+#include "BallTracker.h"
+#include "LineDetector.h"
+#include "LineTracker.h"
+#include "CourtModel.h"
+#include "Config.h"
+
+// Tuỳ chọn của 1 session (thay cho các hằng Config / cờ CLI của app). Mặc định lấy theo Config.
+struct SessionOptions {
+    // Line biên cho sẵn; không có thì lấy line dài nhất của frame đầu (autoCourtLine)
+    bool hasCourtLine = false;
+    CourtLine courtLine;
+    bool autoCourtLine = true;
+    bool hasOutRefPoint = false;
+    cv::Point2f outRefPoint;        // Điểm phía OUT của line; không có thì mép phải giữa frame
+
+    bool courtModel = Config::COURT_MODEL;
+    std::vector<cv::Point2f> courtCorners; // 4 góc sân nhập tay (gần-trái, gần-phải, xa-phải, xa-trái)
+    bool lineTracking = Config::LINE_TRACKING;
+    bool tiled = Config::TILED_INFERENCE;
+};
+
+// 1 frame có bóng chính hoặc có bounce (đúng những frame EventWriter ghi)
+struct SessionEvent {
+    long frameIndex;
+    double timestampMs;
+    TrackResult track;
+};
+
+// Phân tích 1 video / clip trong process của caller: tạo 1 lần, đẩy frame theo thứ tự, nhận event.
+// Detector mượn từ ModelPool (đã load + warm) và trả lại khi session huỷ, nên ingest hàng nghìn clip ngắn
+// không tốn khởi động process, parse model hay lần inference nguội cho mỗi clip. Không dùng highgui.
+// Mỗi session chạy trên luồng gọi push(); nhiều session song song trên nhiều luồng, tối đa models.size()
+// session cùng lúc (session sau chờ ở constructor).
+//
+// track() là bước lõi của mỗi frame cho mọi mode (app, live, segmented, server, replay):
+// tracker.update -> line tracking (+ calibrate lại sân khi line được detect lại) -> bounce IN/OUT.
+// Mode tự lo detect (pipeline, batch nhiều stream, ROI, cadence, ...) thì tạo session không có ModelPool
+// và gọi track() với detection của mình thay vì push().
+//
+//   ModelPool models(Config::MODEL_PATH, 4);
+//   AnalysisSession session(models);
+//   session.onEvent([&](const SessionEvent& e) { ... });
+//   while (cap.read(frame)) session.push(frame, cap.get(cv::CAP_PROP_POS_MSEC));
+class AnalysisSession {
+public:
+    using EventFn = std::function<void(const SessionEvent&)>;
+
+    explicit AnalysisSession(ModelPool& models, const SessionOptions& options = SessionOptions());
+    // Không mượn detector: chỉ dùng track(), không dùng push()
+    explicit AnalysisSession(const SessionOptions& options = SessionOptions());
+
+    // Gọi cho mỗi event ngay trong push(); không đặt thì event được giữ lại cho takeEvents()
+    void onEvent(const EventFn& fn) { eventFn = fn; }
+
+    // Chọn line biên / calibrate sân / chia tile từ frame đầu. push() và track() tự gọi ở frame đầu;
+    // gọi trước khi cần court() / tiles() / courtLine() trước frame đầu tiên.
+    void begin(const cv::Mat& firstFrame);
+    // Không có pixel (replay trace): chỉ dùng line biên và góc sân trong options
+    void begin(cv::Size frameSize);
+
+    // Xử lý frame kế tiếp (detect -> track -> bounce), trả về kết quả track của frame.
+    const TrackResult& push(const cv::Mat& frame, double timestampMs);
+
+    // Bước lõi của 1 frame với detection do caller chạy, kết quả ghi vào result. Không phát event.
+    // frameIndex nhảy cóc (live bỏ frame) -> tracker được tiến qua các frame bị bỏ trước khi update.
+    // Trả về true nếu có bóng chính.
+    bool track(const cv::Mat& frame, long frameIndex, const std::vector<Detection>& detections,
+               TrackResult& result);
+    // Replay: box + thống kê màu đã tính sẵn, không có frame (không line tracking).
+    // frameLine = line biên ghi cho frame này, nullptr = frame không có line.
+    bool track(const std::vector<cv::Rect>& boxes, const std::vector<ColorStats::RoiStats>& stats,
+               const CourtLine* frameLine, TrackResult& result);
+
+    // Lấy các event tích luỹ từ lần gọi trước (khi không dùng onEvent)
+    std::vector<SessionEvent> takeEvents();
+
+    long frames() const { return frameIndex; }
+    long events() const { return eventCount; }
+    bool hasCourtLine() const { return lineFound; }
+    const CourtLine& courtLine() const { return line; }
+    cv::Point2f outRef() const { return outRefPoint; }
+    // Line biên vừa đổi ở lần track() gần nhất (line tracking)
+    bool courtLineChanged() const { return lineChanged; }
+    const CourtModel& court() const { return courtModel; }
+    const std::vector<cv::Rect>& tiles() const { return tileRects; }
+    const LineTracker& lines() const { return lineTracker; }
+    // Scheduler ROI / cadence của app cần Kalman và template của tracker
+    BallTracker& ballTracker() { return tracker; }
+
+private:
+    ModelPool::Lease detector;
+    SessionOptions options;
+    EventFn eventFn;
+
+    BallTracker tracker;
+    LineDetector lineDetector;
+    LineTracker lineTracker;
+    CourtModel courtModel;
+    bool begun = false;
+    bool lineFound = false;
+    bool lineChanged = false;
+    CourtLine line;
+    cv::Point2f outRefPoint;
+    std::vector<cv::Rect> tileRects;
+
+    long frameIndex = 0;
+    long lastTrackedIndex = -1; // frameIndex của lần track(frame) trước, để phát hiện frame bị bỏ
+    long eventCount = 0;
+    TrackResult result;
+    std::vector<Detection> detections;
+    std::vector<cv::Rect> boxes;
+    std::vector<SessionEvent> pending;
+
+    // Line biên, mô hình sân và tile từ frame đầu (frame rỗng = chỉ dùng options)
+    void setup(const cv::Mat& frame, cv::Size frameSize);
+    // Line tracking + IN/OUT sau tracker.update
+    void judge(const cv::Mat& frame, long frameIndex, bool hasBall, TrackResult& result);
+};
+
+#endif
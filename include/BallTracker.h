@@ -2,34 +2,93 @@
 #define BALL_TRACKER_H
 
 #include <opencv2/opencv.hpp>
+#include <string>
 #include <vector>
-#include <map>
+#include "KalmanBank.h"
+#include "LinearAssignment.h"
+#include "SpatialGrid.h"
+#include "ColorStats.h"
+#include "CourtModel.h"
+#include "TrajectoryFitter.h"
+#include "FixedRing.h"
+#include "Config.h"
 
+// 1 slot trong bảng track; slot i dùng filter i của kalman_bank
 struct TrackedObj {
+    int id = -1;
     cv::Point2f pos;
     cv::Rect bbox;
-    int miss_count;
-    float total_dist;
-    float avg_brightness; // Độ sáng trung bình để filter shadow
+    int miss_count = 0;
+    float total_dist = 0.0f;
+    float avg_brightness = 0.0f; // Độ sáng trung bình để filter shadow
+    bool active = false;
+    bool updated = false;        // Đã được cập nhật trong frame hiện tại
+};
+
+// Kết quả tracking của 1 frame: đủ để vẽ overlay hoặc xuất event mà tracker không phải vẽ vào frame
+struct TrackResult {
+    bool hasBall = false;
+    int trackId = -1;
+    cv::Point2f ballPos;
+    cv::Rect ballBox;
+    FixedRing<cv::Point2f, 5> history;  // Vị trí bóng chính các frame gần nhất (tối đa 5)
+    bool hasBounceMarker = false;       // Điểm bounce trước đó (vẽ lại ở các frame sau)
+    cv::Point2f bounceMarker;
+
+    // Từ processBounce
+    bool hasTrajectory = false;         // 3 điểm dùng để tính góc nảy (p0, p1, p2)
+    cv::Point2f trajectory[3];
+    bool bounceDetected = false;
+    bool hasBouncePoint = false;
+    cv::Point2f bouncePoint;
+    float bounceFrameOffset = 0.0f;     // Thời điểm chạm so với frame hiện tại (số frame, <= 0, lẻ được)
+    std::string verdict;                // "IN" / "OUT" / "ON LINE"
+    int zone = -1;                      // CourtModel::Zone của điểm nảy (-1 = không dùng mô hình sân)
+    bool hasCourtPos = false;
+    cv::Point2f courtPos;               // Điểm nảy trong toạ độ sân (mét)
+
+    // Live mode: capture -> quyết định của frame này (ms, < 0 = không đo)
+    float latencyMs = -1.0f;
 };
 
 class BallTracker {
 public:
     BallTracker();
     
-    // Trả về tâm bóng chính (main ball) sau khi xử lý logic
-    bool update(const std::vector<cv::Rect>& detections, cv::Mat& frame, cv::Point2f& outCenter);
+    // Trả về true nếu có bóng chính (main ball), kết quả ghi vào result (tâm bóng: result.ballPos).
+    // Không vẽ vào frame; overlay do Renderer vẽ từ result.
+    bool update(const std::vector<cv::Rect>& detections, const cv::Mat& frame, TrackResult& result);
+    // Như trên nhưng thống kê màu của từng bbox đã có sẵn (replay trace, không cần frame)
+    bool update(const std::vector<cv::Rect>& detections, const std::vector<ColorStats::RoiStats>& stats,
+                TrackResult& result);
+    // Có `count` frame không qua update() (bị nguồn live bỏ): tiến đồng hồ quỹ đạo và predict Kalman qua
+    // các bước đó, để fit parabol / thời điểm bounce / vị trí dự đoán vẫn theo trục thời gian thật
+    void skipFrames(long count);
+    // Thống kê màu của các detection trong lần update(frame) gần nhất (cùng thứ tự detections)
+    const std::vector<ColorStats::RoiStats>& detectionStats() const { return det_stats; }
+
+    // Logic logic phát hiện bounce và IN/OUT cho bóng chính result.ballPos
+    void processBounce(TrackResult& result, cv::Point2f linePt1, cv::Point2f linePt2, cv::Point2f outRefPoint);
+    // Như trên nhưng IN/OUT và vùng sân lấy từ raster của mô hình sân đầy đủ
+    void processBounce(TrackResult& result, const CourtModel& court);
+
+    // Vị trí Kalman dự đoán của bóng chính ở frame tiếp theo, kèm vận tốc và kích thước bbox gần nhất.
+    // Trả về false khi chưa có bóng chính hoặc đã mất track quá ROI_MAX_COAST frame.
+    bool predictMainBall(cv::Point2f& outPos, cv::Point2f& outVelocity, cv::Size& outSize) const;
+
+    // Helper function: Tính độ sáng trung bình trong bbox để filter shadow
+    static float computeBrightness(const ColorStats::RoiStats& stats);
 
-    // Logic logic phát hiện bounce và IN/OUT
-    void processBounce(cv::Mat& frame, cv::Point2f currentPos, 
-                       cv::Point2f linePt1, cv::Point2f linePt2, cv::Point2f outRefPoint);
+    // Helper function: Kiểm tra xem bbox có phải màu đen/xám không (stats từ ColorStats::compute)
+    static bool isBlackOrGray(const ColorStats::RoiStats& stats);
 
 private:
-    std::map<int, TrackedObj> tracking_objects;
+    // Bảng track liên tục MAX_TRACKS slot (thay cho std::map)
+    std::vector<TrackedObj> tracks;
     int next_id = 0;
     
     // History vị trí để tính góc nảy (tương tự ball_positions trong Python)
-    std::vector<cv::Point2f> position_history;
+    FixedRing<cv::Point2f, 5> position_history;
     // Lưu centers của 2 frame trước để kiểm tra 3 frame trùng nhau
     std::vector<cv::Point2f> prev_frame_centers_1; // Frame n-1
     std::vector<cv::Point2f> prev_frame_centers_2; // Frame n-2
@@ -37,12 +96,59 @@ private:
     cv::Size last_ball_size = cv::Size(0,0);
     cv::Point2f bounce_point = cv::Point2f(-1, -1); // Lưu điểm bounce để vẽ lại
     bool has_bounce_point = false;
-    
-    // Helper function: Tính độ sáng trung bình trong bbox để filter shadow
-    float computeBrightness(const cv::Rect& bbox, const cv::Mat& frame);
-    
-    // Helper function: Kiểm tra xem bbox có phải màu đen/xám không
-    bool isBlackOrGray(const cv::Rect& bbox, const cv::Mat& frame);
+
+    // Quỹ đạo bóng chính (Config::TRAJECTORY_FIT); thời gian = số lần update (frame)
+    TrajectoryFitter trajectory;
+    long frame_clock = 0;
+    bool has_fit_bounce = false;    // Điểm của frame hiện tại vừa xác nhận 1 bounce
+    TrajectoryFitter::Bounce fit_bounce;
+
+    // Mỗi track có 1 filter trong bank; predict/correct toàn bộ track trong 1 lượt mỗi frame
+    KalmanBank<Config::MAX_TRACKS> kalman_bank;
+    // Track của bóng chính, dùng để dự đoán vùng detect (ROI) của frame sau
+    int main_track_slot = -1;
+    int main_track_id = -1;
+    int main_lost_frames = 0;
+
+    // Detection của frame hiện tại sau khi lọc, slot = track được gán (-1 nếu chưa có)
+    struct Candidate {
+        cv::Rect box;
+        cv::Point2f center;
+        float brightness;
+        int slot;
+    };
+    struct GatePair {
+        int det;
+        int slot;
+        float dist;
+    };
+
+    // Buffer tái sử dụng giữa các frame
+    std::vector<ColorStats::RoiStats> det_stats;
+    std::vector<Candidate> candidates;
+    std::vector<cv::Point2f> current_frame_centers;
+    std::vector<int> used_slots;
+    std::vector<cv::Point2f> gate_points;
+    std::vector<int> gate_slots;
+    std::vector<GatePair> gate_pairs;
+    int slot_row[Config::MAX_TRACKS];
+    std::vector<int> det_col;
+    std::vector<int> row_slots;
+    std::vector<int> col_dets;
+    std::vector<float> cost_matrix;
+    std::vector<int> row_to_col;
+    std::vector<int> prev_ids;
+    SpatialGrid track_grid;
+    SpatialGrid prev_grid_1;
+    SpatialGrid prev_grid_2;
+    LinearAssignment assignment;
+
+    // Gán detection với track: gate bằng lưới không gian quanh vị trí Kalman dự đoán,
+    // rồi Hungarian trên ma trận chi phí (khoảng cách) chỉ gồm các cặp qua gate
+    void associate();
+    int allocateSlot();
+    // Phát hiện bounce của bóng chính, điểm chạm đất ghi vào inter (và result.bouncePoint)
+    bool detectBounce(TrackResult& result, cv::Point2f& inter);
 };
 
 #endif
\ No newline at end of file
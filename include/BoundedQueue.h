@@ -0,0 +1,90 @@
+#ifndef BOUNDED_QUEUE_H
+#define BOUNDED_QUEUE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+// Hàng đợi có giới hạn dung lượng, dùng để nối các stage của pipeline.
+// push() chặn khi đầy, pop() chặn khi rỗng. Sau close(), push() trả về false
+// và pop() trả về false khi đã lấy hết phần tử còn lại.
+// Phần tử nằm trong ring cấp phát 1 lần lúc tạo (T cần default-constructible), push / pop không cấp phát.
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) : items(capacity > 0 ? capacity : 1) {}
+
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mtx);
+        notFull.wait(lock, [this]() { return closed || count < items.size(); });
+        if (closed) return false;
+        put(std::move(item));
+        return true;
+    }
+
+    // Như push() nhưng không chờ: trả về false khi đầy hoặc đã close
+    bool tryPush(T item) {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (closed || count == items.size()) return false;
+        put(std::move(item));
+        return true;
+    }
+
+    bool pop(T& out) {
+        std::unique_lock<std::mutex> lock(mtx);
+        notEmpty.wait(lock, [this]() { return closed || count > 0; });
+        if (count == 0) return false; // Đã close và hết phần tử
+        take(out);
+        return true;
+    }
+
+    // Như pop() nhưng chỉ chờ tới deadline; trả về false khi hết giờ hoặc queue đã close và rỗng
+    bool popUntil(T& out, std::chrono::steady_clock::time_point deadline) {
+        std::unique_lock<std::mutex> lock(mtx);
+        if (!notEmpty.wait_until(lock, deadline, [this]() { return closed || count > 0; })) {
+            return false;
+        }
+        if (count == 0) return false;
+        take(out);
+        return true;
+    }
+
+    // Như pop() nhưng không chờ
+    bool tryPop(T& out) {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (count == 0) return false;
+        take(out);
+        return true;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mtx);
+        closed = true;
+        notEmpty.notify_all();
+        notFull.notify_all();
+    }
+
+private:
+    std::mutex mtx;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+    std::vector<T> items;
+    size_t head = 0;
+    size_t count = 0;
+    bool closed = false;
+
+    void put(T&& item) {
+        items[(head + count) % items.size()] = std::move(item);
+        ++count;
+        notEmpty.notify_one();
+    }
+    void take(T& out) {
+        out = std::move(items[head]);
+        head = (head + 1) % items.size();
+        --count;
+        notFull.notify_one();
+    }
+};
+
+#endif
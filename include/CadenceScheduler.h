@@ -0,0 +1,66 @@
+#ifndef CADENCE_SCHEDULER_H
+#define CADENCE_SCHEDULER_H
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+#include "YoloDecoder.h"
+#include "LineDetector.h"
+
+class BallTracker;
+struct TrackResult;
+
+// Adaptive detection cadence: YOLO chỉ chạy mỗi k frame (key frame), các frame ở giữa bóng chính
+// được bám bằng template matching trên patch bóng của key frame, quanh vị trí Kalman dự đoán.
+// k tăng dần tới CADENCE_MAX_INTERVAL khi bóng bay ổn định, về 1 khi: mất bóng, confidence thấp,
+// đổi hướng đột ngột, quỹ đạo dự đoán tới gần line biên, hoặc vừa có bounce —
+// để processBounce vẫn có vị trí dày ở những đoạn quyết định IN/OUT.
+//
+//   if (!cadence.trackOnly(frame, index, tracker, detections)) {
+//       detections = detector.detect(frame);
+//       cadence.keyFrame(index, detections);
+//   }
+//   tracker.update(...);
+//   cadence.observe(frame, index, result);
+class CadenceScheduler {
+public:
+    CadenceScheduler();
+
+    // Có line biên -> detect dày khi quỹ đạo dự đoán đi vào vùng gần line
+    void setCourtLine(const CourtLine& line);
+
+    // Frame không cần YOLO: trả về true và ghi detection của bóng chính (từ template) vào out.
+    // Trả về false khi tới key frame hoặc tracking không đủ tin cậy -> caller chạy detector.
+    bool trackOnly(const cv::Mat& frame, long frameIndex, const BallTracker& tracker, std::vector<Detection>& out);
+
+    // Báo kết quả detector của key frame
+    void keyFrame(long frameIndex, const std::vector<Detection>& detections);
+
+    // Báo kết quả track của frame vừa xử lý (gọi sau BallTracker::update / processBounce)
+    void observe(const cv::Mat& frame, long frameIndex, const TrackResult& result);
+
+    int interval() const { return k; }
+    long keyFrames() const { return keyCount; }
+    long trackedFrames() const { return trackCount; }
+
+private:
+    int k = 1;
+    long lastKeyIndex = -1;
+    float lastKeyConf = 0.0f;
+    int denseHold = 0;        // Số frame còn phải detect mỗi frame (sau bounce)
+    bool forceKey = true;     // Frame sau bắt buộc là key frame
+
+    cv::Mat templ;            // Patch gray của bóng chính ở key frame gần nhất
+    cv::Mat searchGray;       // Buffer tái sử dụng
+    cv::Mat matchScores;
+
+    bool hasLine = false;
+    CourtLine line;
+
+    long keyCount = 0;
+    long trackCount = 0;
+
+    // Vị trí dự đoán trong vài frame tới có chạm vùng CADENCE_LINE_MARGIN quanh line biên không
+    bool nearLine(cv::Point2f pos, cv::Point2f velocity) const;
+};
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef CLIP_RECORDER_H
+#define CLIP_RECORDER_H
+
+#include <opencv2/opencv.hpp>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "BoundedQueue.h"
+
+// Chỉ ghi video quanh các bounce thay vì encode cả trận: preRollFrames frame gần nhất nằm trong ring buffer
+// (cv::Mat dùng lại, copy đè mỗi frame), khi có trigger thì ring được chuyển sang clip cùng postRollFrames
+// frame sau đó (trigger mới trong lúc post-roll kéo dài clip). Clip hoàn chỉnh được encode trên luồng nền;
+// frame của clip đã ghi quay về pool để dùng lại cho ring.
+//
+//   recorder.push(packet.frame, packet.index, packet.track.bounceDetected);
+//   ...
+//   recorder.finish();
+class ClipRecorder {
+public:
+    ClipRecorder(const std::string& directory, double fps, int preRollFrames, int postRollFrames,
+                 int maxClipFrames, size_t maxPendingClips);
+    ~ClipRecorder();
+
+    // Gọi theo đúng thứ tự frame (frame đã vẽ overlay nếu muốn clip có overlay)
+    void push(const cv::Mat& frame, long frameIndex, bool trigger);
+    // Đóng clip đang mở và chờ luồng encode ghi xong mọi clip
+    void finish();
+
+    long clipsWritten() const { return written; }
+    long framesWritten() const { return writtenFrames; }
+
+private:
+    struct Clip {
+        long firstFrame = -1;
+        long eventFrame = -1;
+        std::vector<cv::Mat> frames;
+    };
+
+    std::string directory;
+    double fps;
+    int preRoll;
+    int postRoll;
+    int maxClipFrames;
+
+    // Ring pre-roll: slot (ringHead + i) % preRoll là frame cũ thứ i
+    std::vector<cv::Mat> ring;
+    std::vector<long> ringIndex;
+    int ringHead = 0;
+    int ringCount = 0;
+
+    bool recording = false;
+    Clip current;
+    int remainingPost = 0;
+
+    std::mutex poolMtx;
+    std::vector<cv::Mat> pool;   // Frame đã encode xong, dùng lại cho ring / clip
+
+    BoundedQueue<Clip> pending;
+    std::thread encoder;
+    bool finished = false;
+    long written = 0;            // Chỉ luồng encode ghi, đọc sau finish()
+    long writtenFrames = 0;
+
+    cv::Mat acquire();
+    void closeClip();
+    void encodeLoop();
+};
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef COLOR_STATS_H
+#define COLOR_STATS_H
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+namespace ColorStats {
+    // Thống kê màu trung bình của 1 ROI (thang 0-255, cùng công thức với cvtColor BGR2GRAY / BGR2HSV 8-bit)
+    struct RoiStats {
+        float gray = 0.0f;       // Độ sáng (luminance)
+        float saturation = 0.0f; // S của HSV
+        float value = 0.0f;      // V của HSV
+        bool valid = false;      // false khi bbox nằm ngoài frame
+    };
+
+    // Đọc ROI BGR (hoặc gray) 1 lần, tính cả 3 giá trị trung bình: không cấp phát, SIMD theo pixel (AVX2)
+    RoiStats compute(const cv::Mat& frame, const cv::Rect& bbox);
+
+    // Tính cho mọi bbox của 1 frame; out được resize theo boxes và tái sử dụng giữa các frame
+    void computeBatch(const cv::Mat& frame, const std::vector<cv::Rect>& boxes, std::vector<RoiStats>& out);
+}
+
+#endif
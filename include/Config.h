@@ -7,13 +7,154 @@ namespace Config {
     const std::string SOURCE_VIDEO_PATH = "data/In.mp4";
     const std::string TARGET_VIDEO_PATH = "Out.mp4";
     const std::string MODEL_PATH = "data/model_ver2.onnx"; 
+    const std::string EVENTS_PATH = "events.jsonl"; // Event stream JSON Lines (rỗng = không ghi)
+    // Headless: không vẽ overlay, không encode video, chọn line tự động (có thể bật bằng --headless)
+    const bool HEADLESS = false;
     const float CONF_THRESHOLD = 0.2f;
     const float SCORE_THRESHOLD = 0.4f;
     const float NMS_THRESHOLD = 0.4f;
+    const int NUM_CLASSES = 2; // Số class của model (ball = class 0), cố định lúc compile cho decoder
     
     // Kalman
     const float PROCESS_NOISE = 0.5f;
     const float MEASUREMENT_NOISE = 5.0f;
+    const int MAX_TRACKS = 256; // Số track tối đa (kích thước cố định của bảng track / Kalman bank)
+
+    // Bounce từ quỹ đạo: các đoạn parabol fit bằng RLS, bounce = ngắt đoạn, điểm chạm nội suy dưới 1 frame.
+    // false: dùng cách cũ (góc giữa 3 điểm cuối < 150 độ, giao 2 dây cung)
+    const bool TRAJECTORY_FIT = true;
+    const int TRAJ_MIN_POINTS = 3;          // Số điểm tối thiểu của đoạn trước khi kiểm tra ngắt đoạn
+    const int TRAJ_CONFIRM_POINTS = 2;      // Số điểm lệch liên tiếp để xác nhận ngắt đoạn (1..4)
+    const int TRAJ_MAX_GAP = 6;             // Mất bóng lâu hơn N frame -> quỹ đạo mới
+    const float TRAJ_BREAK_PX = 6.0f;       // Sai lệch tối thiểu so với dự đoán để coi là lệch đoạn (pixel)
+    const float TRAJ_BREAK_SIGMA = 4.0f;    // Hoặc N lần độ lệch chuẩn dự đoán của RLS nếu lớn hơn
+    const float TRAJ_MIN_KICK = 1.5f;       // vy sau ngắt đoạn phải giảm ít nhất N pixel/frame (bị đẩy lên)
+    const double TRAJ_MEASUREMENT_VAR = 4.0; // Phương sai nhiễu vị trí detection (pixel^2)
+    const double TRAJ_CURVATURE_VAR = 0.05;  // Phương sai prior độ cong của đoạn mới quanh độ cong đoạn cũ
+
+    // Pipeline đa luồng
+    const int DETECT_WORKERS = 4;   // Số luồng chạy YOLO song song (mỗi luồng 1 cv::dnn::Net)
+    const int QUEUE_CAPACITY = 8;   // Dung lượng hàng đợi giữa các stage
+    // Batch inference: gom tối đa BATCH_SIZE frame cho 1 lần forward, chờ tối đa BATCH_TIMEOUT_MS
+    // để gom đủ batch. Job offline có thể tăng BATCH_SIZE để đổi latency lấy frames/sec.
+    // Model ONNX cần được export với batch động, nếu không sẽ tự quay về batch = 1.
+    const int BATCH_SIZE = 1;
+    const int BATCH_TIMEOUT_MS = 20;
+
+    // Mô hình sân đầy đủ (--court): homography từ line biên, IN/OUT + vùng sân bằng 1 lần tra raster
+    const bool COURT_MODEL = false;
+    const float COURT_RASTER_CM = 1.0f;        // Độ phân giải raster nhãn trong toạ độ sân (cm / pixel)
+    const int COURT_RASTER_DOWNSCALE = 2;      // Raster ảnh = frame / N mỗi chiều
+    const float COURT_HORIZONTAL_MAX_DEG = 30.0f; // Line lệch ngang ít hơn N độ thuộc họ baseline / kitchen line
+
+    // Line tracking (--track-lines): fit lại line biên đã chọn theo thời gian thay vì cố định line frame đầu
+    const bool LINE_TRACKING = false;
+    const int LINE_TRACK_INTERVAL = 3;          // Fit lại mỗi N frame
+    const int LINE_TRACK_SAMPLES = 40;          // Số điểm lấy mẫu dọc line
+    const int LINE_TRACK_BAND = 24;             // Nửa độ rộng dải tìm vệt trắng quanh line cũ (pixel)
+    const int LINE_TRACK_STEP = 2;              // Bước lấy mẫu trên đoạn vuông góc (pixel)
+    const float LINE_TRACK_MIN_SUPPORT = 0.5f;  // Tỉ lệ điểm mẫu tìm thấy vệt trắng tối thiểu
+    const float LINE_TRACK_MIN_RESIDUAL = 2.0f; // Residual (RMS, pixel) luôn chấp nhận được
+    const float LINE_TRACK_RESIDUAL_JUMP = 3.0f; // Residual > N lần trung bình -> detect lại cả frame
+    const float LINE_REDETECT_MAX_DIST = 150.0f; // Line detect lại phải có trung điểm cách line cũ < N pixel
+    const float LINE_REDETECT_MAX_ANGLE_DEG = 15.0f;
+    const int LINE_REDETECT_MAX_BACKOFF = 96;   // Detect lại thất bại liên tiếp -> chờ gấp đôi, tối đa N frame
+
+    // Adaptive cadence (--adaptive): YOLO mỗi k frame, frame ở giữa bám bóng bằng template matching.
+    // k tăng tới CADENCE_MAX_INTERVAL khi bóng bay ổn định, về 1 gần bounce / line biên / khi mất tin cậy.
+    const bool ADAPTIVE_CADENCE = false;
+    const int CADENCE_MAX_INTERVAL = 4;     // k tối đa (số frame giữa 2 lần chạy YOLO)
+    const float CADENCE_MIN_CONF = 0.4f;    // Confidence YOLO ở key frame thấp hơn -> k = 1
+    const float CADENCE_MIN_MATCH = 0.6f;   // Điểm template matching (TM_CCOEFF_NORMED) thấp hơn -> chạy YOLO
+    const float CADENCE_TURN_DEG = 25.0f;   // Quỹ đạo đổi hướng hơn N độ -> k = 1
+    const float CADENCE_LINE_MARGIN = 80.0f; // Dự đoán đi vào vùng N pixel quanh line biên -> k = 1
+    const int CADENCE_BOUNCE_HOLD = 5;      // Sau bounce detect mỗi frame thêm N frame
+    const float CADENCE_SEARCH_SCALE = 3.0f; // Nửa cửa sổ tìm template = N * kích thước bóng + vận tốc / 2
+
+    // Motion gate (--motion-gate): so sánh frame thu nhỏ với frame trước, frame tĩnh không chạy YOLO,
+    // chuyển động gọn 1 vùng thì chỉ detect vùng đó (input nhỏ hơn nếu model hỗ trợ input động)
+    const bool MOTION_GATE = false;
+    const int MOTION_DOWNSCALE_WIDTH = 160;         // Chiều rộng ảnh so sánh
+    const int MOTION_PIXEL_THRESHOLD = 20;          // Chênh lệch gray tối thiểu để coi là pixel đổi
+    const int MOTION_MIN_PIXELS = 3;                // Số pixel đổi (ảnh nhỏ) tối thiểu để coi là có chuyển động
+    const int MOTION_HOLD_FRAMES = 10;              // Detect tiếp N frame sau lần cuối thấy chuyển động
+    const float MOTION_REGION_PADDING = 96.0f;      // Nới vùng chuyển động mỗi phía (pixel frame gốc)
+    const float MOTION_MAX_REGION_FRACTION = 0.5f;  // Vùng lớn hơn tỉ lệ này của frame -> detect cả frame
+
+    // Server nhiều stream (--stream <nguồn> lặp lại): N sân dùng chung pool detector
+    const int SERVER_DETECT_WORKERS = 2;      // Số cv::dnn::Net dùng chung cho mọi stream
+    const int SERVER_MAX_BATCH = 8;           // Batch tối đa gom từ nhiều stream
+    const int SERVER_LATENCY_BUDGET_MS = 100; // Hạn từ lúc decode tới lúc forward xong của 1 frame
+
+    // Precision khi forward trên CPU (--precision fp32|fp16|int8)
+    const std::string INFERENCE_PRECISION = "fp32";
+    const std::string CALIBRATION_DIR = "data/calib"; // Frame calibration INT8 do PickleballCalibrate ghi
+    const int CALIBRATION_MAX_FRAMES = 64;            // Số frame tối đa dùng để lượng tử khi load model
+
+    // Highlight clip (--clips): không encode cả video, chỉ ghi clip quanh mỗi bounce vào CLIP_DIR
+    const bool CLIP_RECORDING = false;
+    const std::string CLIP_DIR = "clips";
+    const int CLIP_PRE_ROLL_FRAMES = 60;   // Số frame trước bounce (ring buffer)
+    const int CLIP_POST_ROLL_FRAMES = 45;  // Số frame sau bounce cuối cùng của clip
+    const int CLIP_MAX_FRAMES = 600;       // Clip dài hơn bị cắt (rally nhiều bounce liên tiếp)
+    const int CLIP_MAX_PENDING = 4;        // Số clip chờ encode tối đa trước khi chặn luồng encode chính
+
+    // Xử lý file dài theo đoạn song song (--segments <workers>): mỗi worker decode + detect + track 1 đoạn,
+    // event ghép lại theo thứ tự frame. Chỉ xuất event, không encode video.
+    const int SEGMENTS_PER_WORKER = 4;        // Chia nhỏ hơn số worker để cân tải giữa các đoạn
+    const int SEGMENT_MIN_FRAMES = 900;       // Đoạn không ngắn hơn N frame (overlap chiếm ít)
+    const int SEGMENT_OVERLAP_FRAMES = 30;    // Số frame làm nóng tracker trước đầu mỗi đoạn
+    const float SEGMENT_MATCH_DIST = 20.0f;   // Bóng 2 đoạn cách nhau < N pixel ở cùng frame overlap -> cùng track
+
+    // Latency từng stage (chỉ có hiệu lực khi build với PICKLEBALL_ENABLE_METRICS)
+    const double METRICS_INTERVAL_S = 5.0;              // In p50/p95/p99/max + fps mỗi N giây
+    const std::string METRICS_JSON_PATH = "metrics.json"; // Báo cáo cuối (rỗng = không ghi)
+    const std::string METRICS_CSV_PATH = "metrics.csv";
+
+    // ROI detection (--roi): detect trên vùng quanh vị trí Kalman dự đoán của bóng chính thay vì cả frame.
+    // Detect phải chạy tuần tự theo frame (cần kết quả track của frame trước) nên chỉ dùng 1 detector.
+    const bool ROI_DETECTION = false;
+    const int ROI_INPUT_SIZE = 320;      // Input network cho crop (model cần input động, nếu không dùng 640)
+    const int ROI_MIN_SIZE = 320;        // Cạnh tối thiểu của vùng crop (pixel frame gốc)
+    const float ROI_BALL_SCALE = 8.0f;   // Cạnh crop >= ROI_BALL_SCALE * kích thước bóng
+    const float ROI_VELOCITY_SCALE = 4.0f; // Nới crop theo vận tốc dự đoán (pixel/frame)
+    const float ROI_MIN_CONF = 0.35f;    // Confidence tốt nhất trong crop thấp hơn -> detect lại cả frame
+    const int ROI_REFRESH_INTERVAL = 15; // Cứ N frame detect cả frame 1 lần để bắt bóng mới
+    const int ROI_MAX_COAST = 5;         // Số frame Kalman tự dự đoán khi mất bóng trước khi bỏ track
+
+    // Tiled inference cho feed độ phân giải cao: chỉ detect trên vùng sân (từ line biên / mô hình sân),
+    // chia thành tile chồng nhau, mỗi tile letterbox vào 640x640 (giữ tỉ lệ) và forward chung 1 batch
+    const bool TILED_INFERENCE = false;
+    const int TILE_SIZE = 1280;                 // Cạnh tile tối đa (pixel frame gốc), tile bị thu nhỏ <= 2x
+    const int TILE_OVERLAP = 96;                // Phần chồng giữa 2 tile kề nhau, > đường kính bóng
+    const float TILE_COURT_MARGIN = 0.10f;      // Nới vùng sân mỗi phía (tỉ lệ kích thước vùng)
+    const float TILE_COURT_MARGIN_TOP = 0.60f;  // Nới phía trên nhiều hơn cho bóng bổng
+    const float TILE_MERGE_OVERLAP = 0.70f;     // Giao / diện tích box nhỏ hơn vượt ngưỡng -> cùng bóng (box bị tile cắt)
+
+    // Trace detection (--record-trace): ghi detection + thống kê màu từng frame để replay tracker
+    // (--replay / PickleballReplay) mà không decode video hay chạy model. Rỗng = không ghi.
+    const std::string TRACE_PATH = "";
+
+    // Video tổng hợp có ground truth (PickleballSynth): đo độ chính xác đi kèm fps của mỗi tối ưu tốc độ
+    const int SYNTH_DISTRACTORS = 4;             // Bóng nhiễu: nửa nằm yên ngoài sân, nửa lăn phía sau sân
+    const float SYNTH_CAMERA_BACK_M = 6.0f;      // Camera sau baseline gần N mét
+    const float SYNTH_CAMERA_HEIGHT_M = 5.5f;    // và cao N mét, nhìn vào giữa sân
+    const float SYNTH_OUT_FRACTION = 0.4f;       // Tỉ lệ cú cuối rally rơi ngoài sân
+    const float SYNTH_CLOSE_CALL_FRACTION = 0.2f; // Tỉ lệ cú đánh rơi trong ±15 cm quanh baseline / sideline
+    const double SYNTH_DEAD_BALL_S = 1.0;        // Bóng chết nảy tiếp N giây rồi biến mất
+    const int SYNTH_MIN_LINE_PX = 8;             // Vạch sân dày tối thiểu (pixel) như vạch thật LineDetector thấy
+    const double SYNTH_MATCH_WINDOW_S = 0.1;     // Bounce báo lệch thời gian <= N giây mới ghép với bounce thật
+    const float SYNTH_ORACLE_MISS = 0.05f;       // --oracle: xác suất mất detection của bóng mỗi frame
+    const float SYNTH_ORACLE_JITTER_PX = 1.5f;   // --oracle: độ lệch chuẩn vị trí box bóng (pixel)
+    const float SYNTH_ORACLE_FALSE_RATE = 0.3f;  // --oracle: xác suất mỗi vật giống bóng thành detection giả
+
+    // Live mode (--live <camera|url|file>): luồng capture chỉ giữ frame mới nhất, quyết định trong hạn
+    const double LIVE_DEADLINE_MS = 100.0;       // Hạn từ lúc capture tới lúc có IN/OUT của frame
+    const int LIVE_DEGRADE_AFTER = 3;            // Trễ hạn N frame liên tiếp -> giảm 1 mức
+    const int LIVE_RECOVER_AFTER = 60;           // N frame liên tiếp dưới ngưỡng hồi phục -> tăng lại 1 mức
+    const double LIVE_RECOVER_RATIO = 0.7;       // Ngưỡng hồi phục = tỉ lệ này * deadline
+    const int LIVE_REDUCED_INPUT_SIZE = 416;     // Input network khi giảm tải (model phải có input động)
+    const int LIVE_MIN_INPUT_SIZE = 320;         // Input network ở mức thấp nhất
 }
 
 #endif // CONFIG_H
\ No newline at end of file
@@ -0,0 +1,70 @@
+#ifndef COURT_MODEL_H
+#define COURT_MODEL_H
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+#include "LineDetector.h"
+
+// Mô hình sân pickleball đầy đủ (baseline, sideline, kitchen line, center line) gắn với ảnh qua homography.
+// Khi calibrate, mô hình được "nướng" thành raster nhãn vùng cùng kích thước frame (thu nhỏ COURT_RASTER_DOWNSCALE),
+// nên phân loại 1 điểm nảy chỉ là 1 lần đọc raster, không tính hình học theo từng bounce.
+//
+// Toạ độ sân (mét): x từ sideline trái (0) tới sideline phải (WIDTH), y từ baseline gần camera (0) tới baseline xa (LENGTH).
+class CourtModel {
+public:
+    // Kích thước sân chuẩn (mét)
+    static constexpr float WIDTH = 6.096f;        // 20 ft
+    static constexpr float LENGTH = 13.411f;      // 44 ft
+    static constexpr float KITCHEN_DEPTH = 2.134f; // 7 ft tính từ lưới, gồm cả kitchen line
+    static constexpr float LINE_WIDTH = 0.0508f;  // 2 in, nằm trong kích thước sân
+
+    enum Zone {
+        ZONE_OUT = 0,
+        ZONE_NEAR_LEFT,     // Ô giao bóng phía gần camera
+        ZONE_NEAR_RIGHT,
+        ZONE_NEAR_KITCHEN,
+        ZONE_FAR_KITCHEN,
+        ZONE_FAR_LEFT,
+        ZONE_FAR_RIGHT,
+        ZONE_COUNT
+    };
+    static const unsigned char ON_LINE = 0x80; // Bit đánh dấu điểm nằm trên vạch trong raster
+
+    struct Classification {
+        int zone = ZONE_OUT;
+        bool onLine = false;
+        bool in = false;        // Vạch tính là IN
+        cv::Point2f courtPos;   // Mét
+    };
+
+    CourtModel();
+
+    // Fit từ các line của LineDetector: 2 line ngang ngoài cùng làm baseline, 2 line dọc ngoài cùng làm sideline
+    bool calibrate(const std::vector<CourtLine>& lines, cv::Size frameSize);
+    // 4 góc sân trong ảnh theo thứ tự: gần-trái, gần-phải, xa-phải, xa-trái
+    bool calibrateCorners(const std::vector<cv::Point2f>& imageCorners, cv::Size frameSize);
+
+    bool valid() const { return calibrated; }
+    // Tăng mỗi lần raster được dựng lại
+    long version() const { return rasterVersion; }
+
+    Classification classify(cv::Point2f imagePt) const;
+    cv::Point2f toCourt(cv::Point2f imagePt) const;
+    const std::vector<cv::Point2f>& corners() const { return imageCorners; }
+
+    static const char* zoneName(int zone);
+
+private:
+    bool calibrated = false;
+    long rasterVersion = 0;
+    cv::Matx33d courtToImage;
+    cv::Matx33d imageToCourt;
+    std::vector<cv::Point2f> imageCorners;
+    cv::Mat raster;        // CV_8U: zone | ON_LINE, kích thước frame / COURT_RASTER_DOWNSCALE
+    cv::Mat courtLabels;   // Nhãn vùng trong toạ độ sân (COURT_RASTER_CM cm / pixel), dựng 1 lần
+
+    void buildCourtLabels();
+    void buildRaster(cv::Size frameSize);
+};
+
+#endif
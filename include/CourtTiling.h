@@ -0,0 +1,25 @@
+#ifndef COURT_TILING_H
+#define COURT_TILING_H
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+#include "LineDetector.h"
+
+// Vùng detect cho tiled inference: bbox của sân (line biên hoặc 4 góc của CourtModel) nới thêm lề,
+// chia thành các tile cùng kích thước chồng lên nhau. Tính 1 lần lúc calibrate, dùng cho mọi frame.
+//
+//   cv::Rect region = CourtTiling::courtRegion(lineDetector.detect(firstFrame), frameSize);
+//   std::vector<cv::Rect> tiles = CourtTiling::layout(region, Config::TILE_SIZE, Config::TILE_OVERLAP);
+//   detector.detectTiles(frame, tiles, detections);
+namespace CourtTiling {
+    // bbox các line + lề TILE_COURT_MARGIN (phía trên TILE_COURT_MARGIN_TOP), cắt theo frame. Rỗng nếu không có line
+    cv::Rect courtRegion(const std::vector<CourtLine>& lines, cv::Size frameSize);
+    // Như trên, từ các góc sân trong ảnh (CourtModel::corners)
+    cv::Rect courtRegion(const std::vector<cv::Point2f>& corners, cv::Size frameSize);
+
+    // Chia region thành lưới tile cạnh <= tileSize, 2 tile kề nhau chồng >= overlap pixel.
+    // Region nhỏ hơn tileSize theo 1 chiều -> 1 tile phủ hết chiều đó.
+    std::vector<cv::Rect> layout(const cv::Rect& region, int tileSize, int overlap);
+}
+
+#endif
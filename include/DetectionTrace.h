@@ -0,0 +1,138 @@
+#ifndef DETECTION_TRACE_H
+#define DETECTION_TRACE_H
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+#include "YoloDecoder.h"
+#include "ColorStats.h"
+#include "LineDetector.h"
+#include "BallTracker.h"
+
+// Trace detection nhị phân (.pbtrace): mọi thứ BallTracker::update / processBounce cần cho 1 frame
+// (box, confidence, thống kê màu đã tính sẵn, line biên của frame) ghi trong lúc chạy bình thường,
+// để chỉnh ngưỡng tracker rồi chạy lại hàng nghìn frame/giây mà không cần decode video hay net.forward.
+//
+// Bố cục file (little-endian, record cỡ cố định, đọc thẳng qua mmap không cần parse):
+//   Header | { Frame, Detection[count] } * frameCount | uint64 offset của từng Frame (bảng index)
+// Header ghi frameCount + indexOffset khi close(); file chưa close (process bị kill) vẫn đọc được tuần tự.
+namespace DetectionTrace {
+    const char MAGIC[8] = {'P', 'B', 'T', 'R', 'A', 'C', 'E', '1'};
+    const uint32_t VERSION = 1;
+
+    enum FrameFlags : uint32_t {
+        FRAME_HAS_LINE = 1u << 0,    // line[] là line biên của frame này
+    };
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t hasCourt;           // courtCorners hợp lệ (mô hình sân đã calibrate)
+        int32_t width;
+        int32_t height;
+        double fps;
+        float outRef[2];             // Điểm mẫu phía OUT của line biên
+        float courtCorners[8];       // Gần-trái, gần-phải, xa-phải, xa-trái
+        uint64_t frameCount;         // 0 = file chưa close
+        uint64_t indexOffset;
+    };
+
+    struct Frame {
+        int64_t index;
+        double timestampMs;
+        uint32_t count;              // Số Detection theo sau
+        uint32_t flags;              // FrameFlags
+        float line[4];               // pt1.x, pt1.y, pt2.x, pt2.y
+    };
+
+    struct Detection {
+        int32_t classId;
+        float confidence;
+        int32_t box[4];              // x, y, width, height
+        float gray;                  // ColorStats::RoiStats
+        float saturation;
+        float value;
+        uint32_t valid;
+    };
+
+    static_assert(sizeof(Header) == 88, "trace header layout");
+    static_assert(sizeof(Frame) == 40, "trace frame layout");
+    static_assert(sizeof(Detection) == 40, "trace detection layout");
+}
+
+// Ghi trace qua ofstream có buffer; gọi write() 1 lần mỗi frame theo thứ tự (luồng track)
+class TraceWriter {
+public:
+    TraceWriter() = default;
+    ~TraceWriter();
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+
+    // court = nullptr hoặc chưa calibrate -> replay dùng line biên của từng frame
+    bool open(const std::string& path, cv::Size frameSize, double fps, cv::Point2f outRefPoint,
+              const CourtModel* court);
+    bool isOpen() const { return out.is_open(); }
+
+    // stats cùng thứ tự với detections (BallTracker::detectionStats() sau update)
+    void write(long frameIndex, double timestampMs, const std::vector<Detection>& detections,
+               const std::vector<ColorStats::RoiStats>& stats, const CourtLine* line);
+
+    // Ghi bảng index + patch header; destructor tự gọi
+    void close();
+    long written() const { return (long)offsets.size(); }
+
+private:
+    std::ofstream out;
+    DetectionTrace::Header header = {};
+    std::vector<uint64_t> offsets;
+    uint64_t position = 0;
+    std::vector<DetectionTrace::Detection> records; // Dùng lại giữa các frame
+};
+
+// Đọc trace qua mmap (Windows: đọc cả file vào bộ nhớ). Các view trỏ thẳng vào vùng map,
+// hợp lệ tới khi reader bị huỷ.
+class TraceReader {
+public:
+    struct FrameView {
+        const DetectionTrace::Frame* frame = nullptr;
+        const DetectionTrace::Detection* detections = nullptr;
+    };
+
+    TraceReader() = default;
+    ~TraceReader();
+    TraceReader(const TraceReader&) = delete;
+    TraceReader& operator=(const TraceReader&) = delete;
+
+    bool open(const std::string& path);
+    bool isOpen() const { return data != nullptr; }
+
+    const DetectionTrace::Header& header() const { return *reinterpret_cast<const DetectionTrace::Header*>(data); }
+    size_t frames() const { return frameOffsets.size(); }
+    FrameView frame(size_t i) const;
+
+private:
+    const char* data = nullptr;
+    size_t size = 0;
+    std::vector<char> fallback;        // Bản đọc cả file khi không có mmap
+    std::vector<uint64_t> frameOffsets;
+
+    void close();
+    bool buildIndex();
+};
+
+namespace DetectionTrace {
+    // Chạy lại BallTracker::update + processBounce trên toàn bộ trace với tracker mới, cùng thứ tự
+    // như luồng track của main (IN/OUT theo mô hình sân nếu header có, nếu không theo line của frame).
+    // onFrame nhận kết quả từng frame (ví dụ EventWriter::write). Trả về số frame đã replay.
+    using FrameFn = std::function<void(long frameIndex, double timestampMs, const TrackResult& result)>;
+    long replay(const TraceReader& trace, const FrameFn& onFrame);
+
+    // Nơi ghi event của replay, cạnh trace: "out/match.pbtrace" -> "out/match.events.jsonl"
+    // (không ghi đè events.jsonl của lần chạy đã ghi trace)
+    std::string eventsPathFor(const std::string& tracePath);
+}
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef EVENT_WRITER_H
+#define EVENT_WRITER_H
+
+#include <fstream>
+#include <string>
+#include "BallTracker.h"
+
+// Ghi kết quả phân tích dạng JSON Lines, mỗi dòng 1 frame có bóng chính hoặc có bounce
+// (frame không có gì bị bỏ qua để stream gọn):
+// {"frame":120,"t_ms":4000.0,"track":7,"ball":[812.5,433.0],"bounce":{"x":805.1,"y":470.2,"verdict":"IN"}}
+// Bounce từ quỹ đạo kèm thời điểm chạm dưới 1 frame: ..."verdict":"IN","frame_exact":118.62}
+// Có mô hình sân thì bounce kèm vùng và toạ độ sân (mét): ..."verdict":"IN","zone":"FAR_LEFT","court_m":[1.524,11.210]}
+// Live mode thì bounce kèm latency capture -> quyết định: ..."verdict":"OUT","latency_ms":42.7}
+class EventWriter {
+public:
+    explicit EventWriter(const std::string& path);
+
+    bool isOpen() const { return out.is_open(); }
+    void write(long frameIndex, double timestampMs, const TrackResult& result);
+    long written() const { return lines; }
+
+private:
+    std::ofstream out;
+    std::string line; // Buffer dòng dùng lại giữa các frame
+    long lines = 0;
+};
+
+#endif
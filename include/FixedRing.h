@@ -0,0 +1,47 @@
+#ifndef FIXED_RING_H
+#define FIXED_RING_H
+
+#include <cstddef>
+
+// Ring buffer dung lượng cố định N nằm ngay trong object (không cấp phát): push_back khi đầy ghi đè phần tử
+// cũ nhất. Chỉ số 0 là phần tử cũ nhất, back() là mới nhất; copy chỉ là copy mảng.
+template <typename T, int N>
+class FixedRing {
+public:
+    static_assert(N > 0, "FixedRing capacity must be positive");
+
+    void push_back(const T& value) {
+        items[(head + count) % N] = value;
+        if (count < N) ++count;
+        else head = (head + 1) % N;
+    }
+    void clear() { head = 0; count = 0; }
+
+    size_t size() const { return (size_t)count; }
+    bool empty() const { return count == 0; }
+    static constexpr size_t capacity() { return (size_t)N; }
+
+    T& operator[](size_t i) { return items[(head + i) % N]; }
+    const T& operator[](size_t i) const { return items[(head + i) % N]; }
+    const T& back() const { return (*this)[count - 1]; }
+
+    class const_iterator {
+    public:
+        const_iterator(const FixedRing* ring, size_t i) : ring(ring), i(i) {}
+        const T& operator*() const { return (*ring)[i]; }
+        const_iterator& operator++() { ++i; return *this; }
+        bool operator!=(const const_iterator& o) const { return i != o.i; }
+    private:
+        const FixedRing* ring;
+        size_t i;
+    };
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, (size_t)count); }
+
+private:
+    T items[N] = {};
+    int head = 0;
+    int count = 0;
+};
+
+#endif
@@ -0,0 +1,101 @@
+#ifndef KALMAN_BANK_H
+#define KALMAN_BANK_H
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+
+// Bank Kalman vận tốc không đổi cho tối đa Capacity track, lưu dạng structure-of-arrays.
+// Model giống KalmanWrapper (F = [I I; 0 I], H = [I 0], Q = q*I, R = r*I): 2 trục x, y độc lập và
+// luôn được đo cùng lúc nên dùng chung 1 ma trận hiệp phương sai 2x2 đối xứng (p00, p01, p11) mỗi track.
+// predictAll()/correctAll() quét toàn bộ slot không rẽ nhánh -> compiler vector hoá được, không cấp phát.
+template <int Capacity>
+class KalmanBank {
+public:
+    KalmanBank(float processNoise, float measurementNoise) : q(processNoise), r(measurementNoise) {
+        for (int i = 0; i < Capacity; ++i) {
+            active[i] = 0;
+            px[i] = py[i] = vx[i] = vy[i] = 0.0f;
+            p00[i] = p11[i] = 1.0f;
+            p01[i] = 0.0f;
+            zx[i] = zy[i] = measured[i] = 0.0f;
+        }
+    }
+
+    // Khởi tạo slot cho track mới tại (x, y) với vận tốc 0
+    void init(int slot, float x, float y) {
+        active[slot] = 1;
+        px[slot] = x; py[slot] = y;
+        vx[slot] = 0.0f; vy[slot] = 0.0f;
+        p00[slot] = 1.0f; p01[slot] = 0.0f; p11[slot] = 1.0f;
+        measured[slot] = 0.0f;
+    }
+
+    void remove(int slot) {
+        active[slot] = 0;
+        vx[slot] = vy[slot] = 0.0f;
+        p00[slot] = p11[slot] = 1.0f;
+        p01[slot] = 0.0f;
+        measured[slot] = 0.0f;
+    }
+    void clear() { for (int i = 0; i < Capacity; ++i) remove(i); }
+
+    // Predict 1 bước cho mọi slot (slot không active cũng được tính, kết quả bỏ qua)
+    void predictAll() {
+        for (int i = 0; i < Capacity; ++i) {
+            px[i] += vx[i];
+            py[i] += vy[i];
+            p00[i] += 2.0f * p01[i] + p11[i] + q;
+            p01[i] += p11[i];
+            p11[i] += q;
+        }
+    }
+
+    // Ghi đo lường cho slot; được áp dụng ở lần correctAll() kế tiếp
+    void measure(int slot, float x, float y) {
+        zx[slot] = x;
+        zy[slot] = y;
+        measured[slot] = 1.0f;
+    }
+
+    // Correct mọi slot có đo lường trong frame này (gain = 0 với slot không có đo lường)
+    void correctAll() {
+        for (int i = 0; i < Capacity; ++i) {
+            float s = p00[i] + r;
+            float k0 = measured[i] * p00[i] / s;
+            float k1 = measured[i] * p01[i] / s;
+            float ix = zx[i] - px[i];
+            float iy = zy[i] - py[i];
+            px[i] += k0 * ix;
+            py[i] += k0 * iy;
+            vx[i] += k1 * ix;
+            vy[i] += k1 * iy;
+            float c01 = p01[i];
+            p11[i] -= k1 * c01;
+            p01[i] = (1.0f - k0) * c01;
+            p00[i] = (1.0f - k0) * p00[i];
+            measured[i] = 0.0f;
+        }
+    }
+
+    bool isActive(int slot) const { return slot >= 0 && slot < Capacity && active[slot]; }
+    cv::Point2f position(int slot) const { return cv::Point2f(px[slot], py[slot]); }
+    cv::Point2f velocity(int slot) const { return cv::Point2f(vx[slot], vy[slot]); }
+    // Vị trí dự đoán ở frame sau (chưa predict)
+    cv::Point2f predicted(int slot) const { return cv::Point2f(px[slot] + vx[slot], py[slot] + vy[slot]); }
+
+private:
+    float q, r;
+    alignas(32) float px[Capacity];
+    alignas(32) float py[Capacity];
+    alignas(32) float vx[Capacity];
+    alignas(32) float vy[Capacity];
+    alignas(32) float p00[Capacity];
+    alignas(32) float p01[Capacity];
+    alignas(32) float p11[Capacity];
+    alignas(32) float zx[Capacity];
+    alignas(32) float zy[Capacity];
+    alignas(32) float measured[Capacity];
+    uint8_t active[Capacity];
+};
+
+#endif
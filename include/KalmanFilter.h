@@ -3,18 +3,25 @@
 
 #include <opencv2/opencv.hpp>
 
+// Kalman vận tốc không đổi (x, y, dx, dy) trên cv::Matx kích thước cố định -> không cấp phát heap
 class KalmanWrapper {
 public:
     KalmanWrapper();
     void init(float px, float py);
     cv::Point2f update(float x, float y); // Correct & Predict
     cv::Point2f predict();                // Chỉ predict
+    cv::Point2f velocity() const;         // Vận tốc ước lượng (pixel/frame)
     bool isInitialized() const { return initialized; }
     void reset();
 
 private:
-    cv::KalmanFilter kf;
+    cv::Matx41f state;
+    cv::Matx44f errorCov;
+    cv::Matx44f transition;
+    cv::Matx44f processNoise;
+    cv::Matx<float, 2, 4> measurement;
+    cv::Matx22f measurementNoise;
     bool initialized = false;
 };
 
-#endif
\ No newline at end of file
+#endif
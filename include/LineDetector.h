@@ -13,8 +13,9 @@ struct CourtLine {
 class LineDetector {
 public:
     std::vector<CourtLine> detect(const cv::Mat& frame);
-    // Chọn line dài nhất làm line biên (đơn giản hóa logic chọn line của Streamlit)
-    bool getMainLine(const cv::Mat& frame, CourtLine& outLine);
+    // Chọn tự động line dài nhất, không mở cửa sổ (headless mode, session nhúng).
+    // Chọn bằng tay qua cửa sổ: LinePicker::selectLine (chỉ có trong app)
+    bool getLongestLine(const cv::Mat& frame, CourtLine& outLine);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,14 @@
+#ifndef LINE_PICKER_H
+#define LINE_PICKER_H
+
+#include <opencv2/opencv.hpp>
+#include "LineDetector.h"
+
+// Chọn line biên bằng cửa sổ highgui (click chọn, SPACE xác nhận, ESC huỷ).
+// Chỉ build vào app Pickleball: thư viện lõi không phụ thuộc highgui.
+namespace LinePicker {
+    // Hiện các line của LineDetector trên frame và chờ user chọn (chặn tới khi xác nhận / huỷ)
+    bool selectLine(LineDetector& detector, const cv::Mat& frame, CourtLine& outLine);
+}
+
+#endif
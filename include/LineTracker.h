@@ -0,0 +1,56 @@
+#ifndef LINE_TRACKER_H
+#define LINE_TRACKER_H
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+#include "LineDetector.h"
+
+// Bám line biên đã chọn qua các frame thay vì cố định line của frame đầu:
+// mỗi LINE_TRACK_INTERVAL frame lấy mẫu dọc line, tìm vệt trắng trên đoạn vuông góc trong dải hẹp
+// quanh vị trí cũ (bước LINE_TRACK_STEP pixel) rồi fit lại line. Chỉ khi residual của fit tăng vọt
+// hoặc còn quá ít điểm (camera bị xê dịch / zoom) mới chạy lại LineDetector::detect trên cả frame
+// và chọn line gần line cũ nhất. Detect lại thất bại liên tiếp (line bị người che) thì các lần thử sau
+// giãn dần gấp đôi, tối đa LINE_REDETECT_MAX_BACKOFF frame.
+class LineTracker {
+public:
+    LineTracker();
+
+    void init(const CourtLine& line);
+
+    // Gọi mỗi frame theo thứ tự; trả về true nếu line thay đổi ở frame này
+    bool update(const cv::Mat& frame, long frameIndex);
+    // Lần update gần nhất thay line bằng 1 lần detect lại cả frame thành công (camera bị dời)
+    bool redetected() const { return lastRedetected; }
+    // Mọi line của lần detect cả frame gần nhất (dùng lại để calibrate sân, không detect lần 2)
+    const std::vector<CourtLine>& detectedLines() const { return frameLines; }
+
+    const CourtLine& line() const { return current; }
+    bool valid() const { return initialized; }
+
+    long refits() const { return refitCount; }
+    long redetections() const { return redetectCount; }          // Chỉ tính lần detect lại thành công
+    long failedRedetections() const { return redetectFailCount; }
+
+private:
+    CourtLine current;
+    bool initialized = false;
+    long lastIndex = -1;
+    float avgResidual = -1.0f;  // EMA residual của các lần fit tốt (pixel)
+    long refitCount = 0;
+    long redetectCount = 0;
+    long redetectFailCount = 0;
+    int failStreak = 0;           // Số lần detect lại thất bại liên tiếp
+    long nextRedetectIndex = -1;  // Back-off: chưa tới frame này thì không detect lại
+    bool lastRedetected = false;
+
+    LineDetector detector;
+    std::vector<cv::Point2f> samples; // Buffer tái sử dụng
+    std::vector<CourtLine> frameLines;
+
+    // Fit lại line trong dải quanh line hiện tại; false nếu không đủ điểm
+    bool refit(const cv::Mat& frame, CourtLine& fitted, float& residual, float& support);
+    // Detect cả frame, chọn line gần line hiện tại nhất
+    bool redetect(const cv::Mat& frame, CourtLine& found);
+};
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef LINEAR_ASSIGNMENT_H
+#define LINEAR_ASSIGNMENT_H
+
+#include <vector>
+
+// Bài toán gán tuyến tính (Hungarian, shortest augmenting path kiểu Jonker-Volgenant) O(n^2 * m)
+// với n = min(rows, cols). Cặp không hợp lệ nên có chi phí lớn và bị loại sau khi giải.
+// Kết quả xác định (cùng input -> cùng output), buffer giữ lại giữa các lần gọi.
+class LinearAssignment {
+public:
+    // cost: ma trận rows x cols (row-major). rowToCol[i] = cột gán cho hàng i, -1 nếu không được gán.
+    void solve(const float* cost, int rows, int cols, std::vector<int>& rowToCol);
+
+private:
+    std::vector<double> u, v, minv;
+    std::vector<int> p, way;
+    std::vector<char> used;
+    std::vector<float> transposed;
+
+    // Yêu cầu n <= m, ghi colToRow (1-based nội bộ) vào p
+    void solveTall(const float* cost, int n, int m);
+};
+
+#endif
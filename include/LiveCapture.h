@@ -0,0 +1,68 @@
+#ifndef LIVE_CAPTURE_H
+#define LIVE_CAPTURE_H
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Đọc camera / stream trên luồng riêng và chỉ giữ frame mới nhất (drop-oldest): frame chưa kịp lấy
+// bị frame sau ghi đè, nên chậm 1 lúc không biến thành độ trễ tích luỹ so với bóng thật.
+// 3 buffer (đang đọc, slot, caller) đổi chỗ cho nhau bằng swap, không cấp phát theo frame.
+//
+//   LiveCapture capture;
+//   capture.open("0");   // Camera 0, hoặc rtsp://..., hoặc file (phát theo fps của file)
+//   capture.start();
+//   while (capture.latest(frame, capturedAt, sequence)) { ... }
+class LiveCapture {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    LiveCapture() = default;
+    ~LiveCapture();
+    LiveCapture(const LiveCapture&) = delete;
+    LiveCapture& operator=(const LiveCapture&) = delete;
+
+    // Chuỗi toàn chữ số = chỉ số camera; file video được phát lại theo fps của file như nguồn live
+    bool open(const std::string& source);
+    cv::Size frameSize() const { return size; }
+    double fps() const { return sourceFps; }
+
+    void start();
+    void stop();
+
+    // Chờ frame mới hơn frame lấy lần trước rồi đổi vào frame (buffer cũ của caller quay lại slot).
+    // capturedAt: lúc cap.read trả về frame; sequence: số thứ tự frame đọc từ nguồn (nhảy cóc khi bị bỏ).
+    // Trả về false khi nguồn hết hoặc đã stop.
+    bool latest(cv::Mat& frame, Clock::time_point& capturedAt, long& sequence);
+
+    long captured() const { return capturedCount.load(std::memory_order_relaxed); }
+    long dropped() const { return droppedCount.load(std::memory_order_relaxed); }
+
+private:
+    cv::VideoCapture cap;
+    cv::Size size;
+    double sourceFps = 0.0;
+    bool paced = false;             // File: đọc theo fps thay vì nhanh nhất có thể
+
+    std::thread thread;
+    std::atomic<bool> running{false};
+    std::mutex mtx;
+    std::condition_variable frameCv;
+    cv::Mat reading;                // Chỉ luồng capture dùng
+    cv::Mat slot;                   // Frame mới nhất, giữ bởi mtx
+    Clock::time_point slotTime;
+    long slotSequence = -1;
+    bool fresh = false;             // Slot chưa được lấy
+    bool ended = false;
+
+    std::atomic<long> capturedCount{0};
+    std::atomic<long> droppedCount{0};
+
+    void captureLoop();
+};
+
+#endif
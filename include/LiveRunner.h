@@ -0,0 +1,77 @@
+#ifndef LIVE_RUNNER_H
+#define LIVE_RUNNER_H
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <string>
+#include <vector>
+#include "YoloDetector.h"
+#include "AnalysisSession.h"
+#include "EventWriter.h"
+#include "LiveCapture.h"
+
+// Live mode cho camera: detect -> AnalysisSession::track tuần tự trên 1 luồng, mỗi vòng lấy frame mới nhất của
+// LiveCapture (frame cũ bị bỏ), không có hàng đợi nào giữa capture và quyết định IN/OUT.
+// Mỗi frame có deadline LIVE_DEADLINE_MS tính từ lúc capture. Trễ deadline LIVE_DEGRADE_AFTER frame liên tiếp
+// thì giảm 1 mức: bỏ overlay + encode, rồi giảm input network (chỉ khi model có input động), rồi chỉ detect
+// 1 frame mỗi 2 frame (frame giữa chỉ track); latency dưới LIVE_RECOVER_RATIO * deadline suốt
+// LIVE_RECOVER_AFTER frame thì tăng lại 1 mức. Latency capture -> quyết định của từng frame nằm trong
+// TrackResult::latencyMs và được ghi kèm mỗi bounce trong events.jsonl.
+class LiveRunner {
+public:
+    enum Level {
+        LEVEL_FULL = 0,         // Overlay + encode, input 640
+        LEVEL_NO_OVERLAY,       // Bỏ vẽ overlay và encode video
+        LEVEL_REDUCED_INPUT,    // + input LIVE_REDUCED_INPUT_SIZE
+        LEVEL_MIN_INPUT,        // + input LIVE_MIN_INPUT_SIZE
+        LEVEL_HALF_RATE,        // + YOLO mỗi 2 frame, frame giữa chỉ track
+        LEVEL_COUNT
+    };
+
+    // options: line biên / mô hình sân / line tracking của session, dựng từ frame live đầu tiên
+    LiveRunner(const std::string& modelPath, double deadlineMs, const SessionOptions& options);
+
+    // Chạy tới khi nguồn hết hoặc requestStop(). writer đang mở -> ghi frame có overlay (chỉ ở LEVEL_FULL).
+    // Trả về số frame đã xử lý (frame bị LiveCapture bỏ không tính).
+    long run(LiveCapture& capture, EventWriter& events, cv::VideoWriter* writer);
+
+    // Gọi được từ luồng khác hoặc signal handler
+    void requestStop() { stopRequested.store(true); }
+
+    int level() const { return currentLevel; }
+    static const char* levelName(int level);
+
+    long deadlineMisses() const { return misses; }
+    long degradations() const { return degradeCount; }
+    double meanLatencyMs() const { return processed > 0 ? latencySumMs / processed : 0.0; }
+    double maxLatencyMs() const { return latencyMaxMs; }
+    // Latency capture -> quyết định của các frame có bounce (ms)
+    const std::vector<float>& bounceLatencies() const { return bounceLatencyMs; }
+    double bounceLatencyPercentile(double q) const; // q trong [0, 1], 0 nếu chưa có bounce
+
+private:
+    YoloDetector detector;
+    bool dynamicInput = true; // false -> bỏ qua các mức giảm input (model input cố định, detectRoi vẫn chạy 640)
+    double deadlineMs;
+    SessionOptions options;
+    std::atomic<bool> stopRequested{false};
+
+    int currentLevel = LEVEL_FULL;
+    int consecutiveMisses = 0;
+    int calmFrames = 0;
+
+    long processed = 0;
+    long misses = 0;
+    long degradeCount = 0;
+    double latencySumMs = 0.0;
+    double latencyMaxMs = 0.0;
+    std::vector<float> bounceLatencyMs;
+
+    int inputSizeFor(int level) const;
+    // Mức kế tiếp theo hướng step (+1 giảm tải, -1 hồi phục), bỏ qua mức không có tác dụng với model này
+    int stepLevel(int level, int step) const;
+    // Cập nhật mức giảm tải theo latency của frame vừa quyết định
+    void adapt(double latencyMs);
+};
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef MODEL_POOL_H
+#define MODEL_POOL_H
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "YoloDetector.h"
+#include "Config.h"
+
+// Các YoloDetector đã load (readNetFromONNX, quantize INT8) và forward thử 1 lần (warm) khi tạo pool,
+// dùng lại cho mọi session trong process: mỗi clip không còn tốn parse model và lần inference nguội đầu tiên.
+// Session mượn 1 detector khi tạo (cv::dnn::Net không forward song song được) và trả lại khi huỷ.
+//
+//   ModelPool models(Config::MODEL_PATH, 4);
+//   ModelPool::Lease detector = models.acquire(); // Chờ nếu cả 4 đang được mượn
+//   detector->detect(frame, detections);
+class ModelPool {
+public:
+    ModelPool(const std::string& modelPath, int size, Precision precision = Precision::FP32,
+              const std::string& calibrationDir = Config::CALIBRATION_DIR);
+    ModelPool(const ModelPool&) = delete;
+    ModelPool& operator=(const ModelPool&) = delete;
+
+    // Quyền dùng 1 detector, tự trả về pool khi huỷ (chỉ move)
+    class Lease {
+    public:
+        Lease() = default;
+        Lease(Lease&& other) noexcept : pool(other.pool), detector(other.detector) { other.detector = nullptr; }
+        Lease& operator=(Lease&& other) noexcept;
+        ~Lease() { reset(); }
+
+        YoloDetector& operator*() const { return *detector; }
+        YoloDetector* operator->() const { return detector; }
+        explicit operator bool() const { return detector != nullptr; }
+        void reset();
+
+    private:
+        friend class ModelPool;
+        Lease(ModelPool* pool, YoloDetector* detector) : pool(pool), detector(detector) {}
+        ModelPool* pool = nullptr;
+        YoloDetector* detector = nullptr;
+    };
+
+    // Mượn 1 detector, chờ tới khi có detector rảnh
+    Lease acquire();
+    // Như acquire() nhưng trả về Lease rỗng ngay nếu không còn detector rảnh
+    Lease tryAcquire();
+
+    int size() const { return (int)detectors.size(); }
+    int available() const;
+
+private:
+    std::vector<std::unique_ptr<YoloDetector>> detectors;
+    std::vector<YoloDetector*> idle;
+    mutable std::mutex mtx;
+    std::condition_variable idleCv;
+
+    void release(YoloDetector* detector);
+};
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef MOTION_GATE_H
+#define MOTION_GATE_H
+
+#include <opencv2/opencv.hpp>
+
+// Cổng chuyển động đặt trước detector: so sánh frame thu nhỏ (gray, blur) với frame trước.
+// - Không có pixel nào đổi (giữa rally, đổi sân, video archive chết) -> bỏ qua inference
+// - Chuyển động nằm gọn 1 vùng -> chỉ detect trên vùng vuông bao quanh, input network nhỏ hơn
+// - Chuyển động khắp frame (camera rung, đổi sáng) -> detect cả frame
+// Chỉ cần frame trước nên chạy được ngay trên luồng decode, không phụ thuộc kết quả track.
+class MotionGate {
+public:
+    MotionGate();
+
+    // Trả về false khi không cần detect frame này. Khi true: region rỗng = detect cả frame,
+    // ngược lại detect trên region (toạ độ frame gốc) với input inputSize x inputSize.
+    bool evaluate(const cv::Mat& frame, cv::Rect& region, int& inputSize);
+
+    long skippedFrames() const { return skipCount; }
+    long regionFrames() const { return regionCount; }
+
+private:
+    cv::Mat resized;
+    cv::Mat small;      // Frame hiện tại thu nhỏ
+    cv::Mat prev;       // Frame trước thu nhỏ
+    cv::Mat diff;
+    cv::Rect lastRegion;
+    int hold = 0;       // Số frame còn detect tiếp sau lần cuối thấy chuyển động
+    long skipCount = 0;
+    long regionCount = 0;
+
+    // Bbox chuyển động (toạ độ ảnh nhỏ) -> vùng vuông có padding trên frame gốc; rỗng nếu quá lớn
+    static cv::Rect toFrameRegion(const cv::Rect& motion, cv::Size smallSize, cv::Size frameSize);
+};
+
+#endif
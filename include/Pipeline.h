@@ -0,0 +1,89 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <opencv2/opencv.hpp>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "YoloDetector.h"
+#include "BallTracker.h"
+#include "LineDetector.h"
+
+// Dữ liệu của 1 frame đi qua các stage
+struct FramePacket {
+    long index = -1;
+    double timestampMs = 0.0; // Thời điểm của frame trong video (CAP_PROP_POS_MSEC)
+    cv::Mat frame;
+    std::vector<Detection> detections;
+    TrackResult track;
+    // Line biên dùng cho frame này (line tracking có thể dời line giữa các frame)
+    bool hasCourtLine = false;
+    CourtLine courtLine;
+
+    // Do stage trước detect (motion gate) đặt: bỏ qua detector, hoặc chỉ detect trên detectRegion
+    bool skipDetect = false;
+    cv::Rect detectRegion;    // Rỗng = cả frame
+    int detectInputSize = 640;
+
+    // Xoá dữ liệu của frame cũ nhưng giữ buffer (frame, detections) để packet được dùng lại không cấp phát
+    void recycle() {
+        index = -1;
+        timestampMs = 0.0;
+        detections.clear();
+        track = TrackResult();
+        hasCourtLine = false;
+        skipDetect = false;
+        detectRegion = cv::Rect();
+        detectInputSize = 640;
+    }
+};
+
+// Pipeline nhiều luồng: decode -> detect (N worker) -> sắp xếp lại thứ tự -> track -> encode.
+// Các stage nối với nhau bằng BoundedQueue nên decode, inference và ghi video chạy chồng lên nhau,
+// throughput bị giới hạn bởi stage chậm nhất thay vì tổng thời gian các stage.
+// Packet ra khỏi encode quay lại decode (frame Mat, detections giữ buffer), nên khi đã chạy ổn định
+// đường đi của 1 frame không cấp phát bộ nhớ.
+class Pipeline {
+public:
+    using StageFn = std::function<void(FramePacket&)>;
+    using DetectFn = std::function<void(YoloDetector&, FramePacket&)>;
+
+    // Mỗi detect worker có 1 YoloDetector riêng (cv::dnn::Net không forward song song được).
+    // Mỗi worker gom tối đa batchSize frame, chờ tối đa batchTimeoutMs trước khi forward batch chưa đầy.
+    Pipeline(const std::string& modelPath, int detectWorkers, size_t queueCapacity,
+             int batchSize = 1, int batchTimeoutMs = 0);
+    // Không có detector: detection do caller tự đặt trong detectFn của run() tuần tự
+    // (trace đã ghi, ground truth tổng hợp); các biến thể run() cần detector trả về 0 ngay
+    explicit Pipeline(size_t queueCapacity);
+
+    // Chạy tới khi hết video. trackFn được gọi tuần tự theo đúng thứ tự frame,
+    // sinkFn (encode) chạy trên luồng gọi run(). Trả về số frame đã xử lý.
+    long run(cv::VideoCapture& cap, const StageFn& trackFn, const StageFn& sinkFn);
+
+    // Biến thể detect tuần tự: detectFn chạy ngay trước trackFn trên luồng track, theo đúng thứ tự frame,
+    // với detector đầu tiên. Dùng khi vùng detect phụ thuộc kết quả track của frame trước (ROI mode);
+    // decode và encode vẫn chạy chồng lên detect + track.
+    long run(cv::VideoCapture& cap, const DetectFn& detectFn, const StageFn& trackFn, const StageFn& sinkFn);
+    // Như trên nhưng detectFn không cần detector (dùng với Pipeline(queueCapacity))
+    long run(cv::VideoCapture& cap, const StageFn& detectFn, const StageFn& trackFn, const StageFn& sinkFn);
+
+    // Hàm chạy trên luồng decode ngay sau khi đọc frame, theo đúng thứ tự frame (vd. motion gate).
+    // Có thể đặt skipDetect / detectRegion cho packet; run() với detectFn để detectFn tự xử lý các cờ này.
+    void setPreDetect(const StageFn& fn) { preDetectFn = fn; }
+
+    // Tiled inference: frame không có detectRegion được detect trên các tile này (YoloDetector::detectTiles)
+    // thay vì cả frame; mỗi frame là 1 batch tile nên không gom batch giữa các frame
+    void setTiles(const std::vector<cv::Rect>& courtTiles) { tiles = courtTiles; }
+
+private:
+    long runInOrder(cv::VideoCapture& cap, const StageFn& detectFn, const StageFn& trackFn, const StageFn& sinkFn);
+
+    StageFn preDetectFn;
+    std::vector<cv::Rect> tiles;
+    std::vector<std::unique_ptr<YoloDetector>> detectors;
+    size_t queueCapacity;
+    int batchSize;
+    int batchTimeoutMs;
+};
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef RENDERER_H
+#define RENDERER_H
+
+#include <opencv2/opencv.hpp>
+#include "BallTracker.h"
+#include "LineDetector.h"
+
+// Vẽ overlay lên frame từ kết quả tracking (tracker không tự vẽ nữa).
+// Chạy ở stage encode, headless mode bỏ qua hoàn toàn.
+namespace Renderer {
+    // Quỹ đạo, bbox bóng chính, điểm bounce, vector góc nảy và kết quả IN/OUT
+    void drawTrack(cv::Mat& frame, const TrackResult& result);
+
+    // Đường biên đã chọn và điểm OUT tham chiếu
+    void drawCourtLine(cv::Mat& frame, const CourtLine& line, cv::Point2f outRefPoint);
+}
+
+#endif
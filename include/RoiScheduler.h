@@ -0,0 +1,34 @@
+#ifndef ROI_SCHEDULER_H
+#define ROI_SCHEDULER_H
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+#include "YoloDetector.h"
+
+class BallTracker;
+
+// Chọn vùng detect cho từng frame trong ROI mode:
+// - Có Kalman dự đoán bóng chính -> detect trên crop vuông quanh vị trí dự đoán (input nhỏ hơn)
+// - Không có track, tới chu kỳ refresh, hoặc crop cho confidence thấp -> detect cả frame
+class RoiScheduler {
+public:
+    RoiScheduler();
+
+    // Detect frame thứ frameIndex (gọi tuần tự theo thứ tự frame, sau khi tracker đã xử lý frame trước),
+    // kết quả ghi đè vào out
+    void detect(YoloDetector& detector, const cv::Mat& frame, long frameIndex, const BallTracker& tracker,
+                std::vector<Detection>& out);
+
+    long roiFrames() const { return roiCount; }
+    long fullFrames() const { return fullCount; }
+
+private:
+    long lastFullIndex = -1;
+    long roiCount = 0;
+    long fullCount = 0;
+
+    // Crop vuông quanh vị trí dự đoán, dịch vào trong frame thay vì cắt để giữ tỉ lệ khi resize
+    static cv::Rect searchWindow(cv::Point2f pos, cv::Point2f velocity, cv::Size ballSize, cv::Size frameSize);
+};
+
+#endif
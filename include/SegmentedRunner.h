@@ -0,0 +1,63 @@
+#ifndef SEGMENTED_RUNNER_H
+#define SEGMENTED_RUNNER_H
+
+#include <opencv2/opencv.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+#include "YoloDetector.h"
+#include "AnalysisSession.h"
+#include "EventWriter.h"
+
+// Xử lý offline file video dài bằng nhiều worker: file được chia thành các đoạn liên tiếp, mỗi worker
+// có VideoCapture, YoloDetector riêng và mỗi đoạn 1 AnalysisSession mới (tracker, line tracking, sân).
+// Mỗi đoạn bắt đầu sớm hơn overlapFrames frame để "làm nóng" tracker (track, Kalman, position_history,
+// cờ bounce) — các frame này thuộc đoạn trước nên không xuất event. Ở mỗi mối nối, bóng chính của 2 đoạn
+// trong vùng overlap được so khớp để nối track id; event được ghi đúng thứ tự frame ngay khi đoạn đó và
+// mọi đoạn trước đã xong, rồi giải phóng.
+class SegmentedRunner {
+public:
+    // options: line biên / góc sân / line tracking / tile dùng chung cho session của mọi đoạn
+    SegmentedRunner(const std::string& modelPath, int workers, int overlapFrames, const SessionOptions& options);
+
+    // Trả về số frame đã xử lý (không tính frame overlap), -1 nếu không đọc được số frame của file
+    long run(const std::string& videoPath, EventWriter& events);
+    // Số đoạn bị bỏ ở lần run() gần nhất (không mở được file, hoặc seek không tới được frame đầu đoạn)
+    long failedSegments() const { return failed; }
+
+private:
+    // Bóng chính của 1 frame trong vùng overlap, dùng để nối track id giữa 2 đoạn
+    struct SeamObservation {
+        long frame;
+        int trackId;
+        cv::Point2f pos;
+    };
+    struct FrameEvent {
+        long frame;
+        double timestampMs;
+        TrackResult track;
+    };
+    struct Segment {
+        long start = 0;                      // Frame đầu thuộc đoạn
+        long end = 0;                        // Frame sau frame cuối
+        long processed = 0;
+        int maxTrackId = -1;
+        bool done = false;                   // Worker đã xử lý xong (giữ bởi khóa ghép event)
+        bool failed = false;                 // Seek sai / không mở được file: đoạn không có event
+        std::vector<FrameEvent> events;
+        std::vector<SeamObservation> head;   // Bóng chính trong overlap trước start (frame làm nóng)
+        std::vector<SeamObservation> tail;   // Bóng chính trong overlapFrames frame cuối đoạn
+    };
+
+    std::string modelPath;
+    int workers;
+    int overlapFrames;
+    SessionOptions options;
+    long failed = 0;
+
+    void processSegment(const std::string& videoPath, YoloDetector& detector, Segment& segment);
+    // Track id của đoạn sau (local) -> track id của đoạn trước (global), theo các frame overlap trùng vị trí
+    static std::vector<std::pair<int, int>> matchSeam(const Segment& prev, const Segment& next);
+};
+
+#endif
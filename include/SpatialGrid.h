@@ -0,0 +1,68 @@
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Lưới băm không gian cho truy vấn lân cận: các điểm được gom theo ô cellSize x cellSize,
+// truy vấn chỉ duyệt 3x3 ô quanh điểm nên chi phí không phụ thuộc tổng số điểm.
+// Mọi điểm cách điểm truy vấn < cellSize đều được duyệt. Buffer giữ lại giữa các lần build.
+class SpatialGrid {
+public:
+    explicit SpatialGrid(float cellSize) : cellSize(cellSize) {}
+
+    void build(const cv::Point2f* points, const int* ids, int count) {
+        entries.clear();
+        for (int i = 0; i < count; ++i) {
+            entries.push_back({keyOf(cellOf(points[i].x), cellOf(points[i].y)), ids[i], points[i]});
+        }
+        // Sắp theo (ô, id) để thứ tự duyệt xác định
+        std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+            return a.key != b.key ? a.key < b.key : a.id < b.id;
+        });
+    }
+
+    // Gọi fn(id, point) cho mọi điểm trong 3x3 ô quanh p
+    template <typename Fn>
+    void forEachNear(cv::Point2f p, Fn&& fn) const {
+        int cx = cellOf(p.x);
+        int cy = cellOf(p.y);
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                int64_t key = keyOf(cx + dx, cy + dy);
+                auto it = std::lower_bound(entries.begin(), entries.end(), key,
+                                           [](const Entry& e, int64_t k) { return e.key < k; });
+                for (; it != entries.end() && it->key == key; ++it) fn(it->id, it->pt);
+            }
+        }
+    }
+
+    // Có điểm nào cách p < radius không (radius <= cellSize)
+    bool anyWithin(cv::Point2f p, float radius) const {
+        bool found = false;
+        forEachNear(p, [&](int, cv::Point2f q) {
+            if (cv::norm(p - q) < radius) found = true;
+        });
+        return found;
+    }
+
+    bool empty() const { return entries.empty(); }
+
+private:
+    struct Entry {
+        int64_t key;
+        int id;
+        cv::Point2f pt;
+    };
+
+    float cellSize;
+    std::vector<Entry> entries;
+
+    int cellOf(float v) const { return (int)std::floor(v / cellSize); }
+    static int64_t keyOf(int cx, int cy) { return ((int64_t)cy << 32) + (int64_t)(uint32_t)cx; }
+};
+
+#endif
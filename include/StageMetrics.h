@@ -0,0 +1,117 @@
+#ifndef STAGE_METRICS_H
+#define STAGE_METRICS_H
+
+// Đo latency từng stage của pipeline: timer theo scope (steady_clock) ghi vào histogram lock-free của stage,
+// báo cáo p50/p95/p99/max + frames/sec định kỳ và lúc kết thúc (console, JSON, CSV).
+// Bật bằng PICKLEBALL_ENABLE_METRICS (option CMake); khi tắt các macro METRICS_* rỗng, không còn code đo nào.
+//
+//   void YoloDetector::preprocess(...) {
+//       METRICS_SCOPE(PREPROCESS);
+//       ...
+//   }
+
+#include <ostream>
+#include <string>
+
+namespace StageMetrics {
+    enum Stage {
+        DECODE,      // cap.read
+        GATE,        // Motion gate trước detector
+        PREPROCESS,  // Resize + chuẩn hoá frame vào blob
+        FORWARD,     // net.forward
+        POSTPROCESS, // Giải mã output YOLO + NMS
+        TRACK,       // BallTracker::update
+        LINES,       // Bounce + IN/OUT theo đường biên
+        RENDER,      // Vẽ overlay
+        WRITE,       // VideoWriter::write
+        EVENTS,      // Ghi event JSON Lines
+        LATENCY,     // Live mode: capture -> quyết định IN/OUT (ghi bằng METRICS_RECORD, không theo scope)
+        STAGE_COUNT
+    };
+
+    const char* stageName(Stage stage);
+}
+
+#ifdef PICKLEBALL_ENABLE_METRICS
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace StageMetrics {
+    // Histogram log-linear (8 bucket con mỗi lũy thừa 2, sai số tương đối <= 12.5%) trên nanosecond.
+    // record() chỉ dùng atomic relaxed nên gọi được từ mọi luồng mà không cần khóa.
+    class Histogram {
+    public:
+        static const int SUB_BITS = 3;
+        static const int LINEAR = 2 << SUB_BITS; // Giá trị < LINEAR có bucket riêng
+        static const int BUCKET_COUNT = LINEAR + (64 - SUB_BITS - 1) * (1 << SUB_BITS);
+
+        void record(uint64_t ns);
+        uint64_t count() const { return total.load(std::memory_order_relaxed); }
+        uint64_t maxNs() const { return maxValue.load(std::memory_order_relaxed); }
+        double meanNs() const;
+        uint64_t percentileNs(double q) const; // q trong [0, 1]
+
+    private:
+        static int bucketOf(uint64_t ns);
+        static uint64_t bucketMid(int index);
+
+        std::atomic<uint64_t> buckets[BUCKET_COUNT] = {};
+        std::atomic<uint64_t> total{0};
+        std::atomic<uint64_t> sum{0};
+        std::atomic<uint64_t> maxValue{0};
+    };
+
+    Histogram& histogram(Stage stage);
+
+    // Điểm gốc để tính frames/sec (lần đo đầu tiên)
+    void markStart();
+
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer(Stage stage) : stage(stage), start(std::chrono::steady_clock::now()) { markStart(); }
+        ~ScopedTimer() {
+            auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+            histogram(stage).record((uint64_t)ns.count());
+        }
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    private:
+        Stage stage;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    // Gọi 1 lần khi 1 frame ra khỏi pipeline
+    void frameDone();
+
+    // In báo cáo nếu đã qua intervalSec kể từ lần in trước (gọi được từ nhiều luồng, chỉ 1 luồng in)
+    void reportPeriodic(std::ostream& os, double intervalSec);
+
+    // Báo cáo tổng kết: bảng trên console + JSON / CSV (đường dẫn rỗng = bỏ qua)
+    void printReport(std::ostream& os);
+    bool writeJson(const std::string& path);
+    bool writeCsv(const std::string& path);
+    void reportFinal(std::ostream& os, const std::string& jsonPath, const std::string& csvPath);
+}
+
+#define METRICS_CONCAT_(a, b) a##b
+#define METRICS_CONCAT(a, b) METRICS_CONCAT_(a, b)
+#define METRICS_SCOPE(stage) StageMetrics::ScopedTimer METRICS_CONCAT(metricsTimer_, __LINE__)(StageMetrics::stage)
+#define METRICS_RECORD(stage, ns) StageMetrics::histogram(StageMetrics::stage).record((uint64_t)(ns))
+#define METRICS_FRAME_DONE() StageMetrics::frameDone()
+#define METRICS_REPORT_PERIODIC(os, intervalSec) StageMetrics::reportPeriodic(os, intervalSec)
+#define METRICS_REPORT_FINAL(os, jsonPath, csvPath) StageMetrics::reportFinal(os, jsonPath, csvPath)
+
+#else
+
+#define METRICS_SCOPE(stage) ((void)0)
+#define METRICS_RECORD(stage, ns) ((void)0)
+#define METRICS_FRAME_DONE() ((void)0)
+#define METRICS_REPORT_PERIODIC(os, intervalSec) ((void)0)
+#define METRICS_REPORT_FINAL(os, jsonPath, csvPath) ((void)0)
+
+#endif // PICKLEBALL_ENABLE_METRICS
+
+#endif // STAGE_METRICS_H
@@ -0,0 +1,66 @@
+#ifndef STREAM_SERVER_H
+#define STREAM_SERVER_H
+
+#include <opencv2/opencv.hpp>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include "YoloDetector.h"
+#include "Pipeline.h"
+#include "BoundedQueue.h"
+
+// 1 nguồn video (file / RTSP / camera) của server
+struct StreamSource {
+    std::string source;
+    std::string outputPath; // Rỗng = không encode video
+    std::string eventsPath; // Rỗng = không ghi event
+};
+
+// Xử lý nhiều sân trong 1 process: mỗi stream có decode, BallTracker và line biên riêng,
+// còn model được load 1 lần cho mỗi detector trong pool dùng chung (detectWorkers << số stream).
+// 1 scheduler chung gom frame của mọi stream thành batch, chờ thêm frame tới khi gần hết
+// hạn latency của frame cũ nhất trong batch (latencyBudgetMs tính từ lúc decode).
+//
+//   decode[0..N) --> requests --> detect worker[0..K) --> detected[i] --> track + encode[i]
+class StreamServer {
+public:
+    StreamServer(const std::string& modelPath, int detectWorkers, int maxBatch, int latencyBudgetMs,
+                 size_t queueCapacity);
+    ~StreamServer();
+
+    // Chạy tới khi mọi stream hết frame (stream không mở được bị bỏ qua). Headless: line biên
+    // được chọn tự động (line dài nhất frame đầu). Trả về tổng số frame đã xử lý.
+    long run(const std::vector<StreamSource>& sources);
+
+    // Motion gate riêng cho mỗi stream: frame tĩnh đi thẳng tới track, không vào hàng đợi detect.
+    // (Vùng chuyển động không dùng ở đây, batch chung giữa các stream luôn là cả frame.)
+    void setMotionGate(bool enabled) { motionGateEnabled = enabled; }
+    // Fit lại line biên của mỗi stream theo thời gian (LineTracker)
+    void setLineTracking(bool enabled) { lineTrackingEnabled = enabled; }
+    // Fit mô hình sân đầy đủ từ frame đầu của mỗi stream, IN/OUT theo vùng sân
+    void setCourtModel(bool enabled) { courtModelEnabled = enabled; }
+
+private:
+    struct Stream;
+    struct Request {
+        Stream* stream = nullptr;
+        FramePacket packet;
+        std::chrono::steady_clock::time_point deadline;
+    };
+
+    std::vector<std::unique_ptr<YoloDetector>> detectors;
+    int maxBatch;
+    std::chrono::milliseconds latencyBudget;
+    size_t queueCapacity;
+    bool motionGateEnabled = false;
+    bool lineTrackingEnabled = false;
+    bool courtModelEnabled = false;
+
+    bool openStream(Stream& stream);
+    void decodeLoop(Stream& stream, BoundedQueue<Request>& requests);
+    void detectLoop(YoloDetector& detector, BoundedQueue<Request>& requests);
+    void trackLoop(Stream& stream);
+};
+
+#endif
@@ -0,0 +1,138 @@
+#ifndef SYNTHETIC_RALLY_H
+#define SYNTHETIC_RALLY_H
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Config.h"
+
+// Video sân pickleball tổng hợp có ground truth chính xác, để đo mỗi tối ưu tốc độ (bỏ frame, input nhỏ,
+// ROI detection, ...) tốn bao nhiêu độ chính xác. Xác định hoàn toàn theo seed.
+//
+// Quỹ đạo bóng được mô phỏng 3D trước (toạ độ sân CourtModel, mét, z hướng lên): mỗi cú đánh là parabol
+// rơi xuống 1 điểm đích ở nửa sân bên kia, nảy lại (mất năng lượng) rồi bị đánh trả; cú cuối rally có thể
+// ra ngoài hoặc sát vạch. Camera pinhole đặt sau baseline gần, nhìn chéo xuống sân. Mỗi frame được vẽ từ
+// nền dựng sẵn (mặt sân, vạch trắng đủ dày cho LineDetector, lưới) + người chơi, bóng nhiễu (đứng yên /
+// lăn), bóng đổ và bóng chính có nhoè chuyển động.
+//
+//   SyntheticRally synth(options);
+//   for (long i = 0; i < synth.frames(); ++i) {
+//       synth.render(i, frame);
+//       ... pipeline ...
+//   }
+//   SyntheticRally::Score score = synth.score(calls);
+class SyntheticRally {
+public:
+    struct Options {
+        cv::Size frameSize = cv::Size(1920, 1080);
+        double fps = 60.0;
+        double seconds = 60.0;
+        uint64_t seed = 1;
+        int distractors = Config::SYNTH_DISTRACTORS;  // Bóng nhiễu (đứng yên ngoài sân / lăn phía sau)
+        bool shadows = true;
+    };
+
+    // Bóng chính ở 1 frame
+    struct BallTruth {
+        bool visible = false;       // Đang trong rally và tâm nằm trong frame
+        cv::Point2f imagePos;
+        float radius = 0.0f;        // Pixel
+        cv::Point3f courtPos;       // Mét
+    };
+
+    // 1 lần bóng chạm đất
+    struct BounceTruth {
+        double frame;               // Thời điểm chạm theo frame (lẻ được)
+        cv::Point2f imagePos;
+        cv::Point2f courtPos;
+        bool in;                    // Tâm bóng trong sân, vạch tính là IN
+    };
+
+    // 1 bounce pipeline báo (TrackResult hoặc dòng events.jsonl)
+    struct BounceCall {
+        double frame;               // frameIndex + bounceFrameOffset
+        bool hasPoint = false;
+        cv::Point2f imagePos;
+        bool hasCourtPos = false;
+        cv::Point2f courtPos;
+        std::string verdict;        // "IN" / "OUT" / "ON LINE"
+    };
+
+    // Ghép call với ground truth: mỗi bounce thật ghép với call gần nhất về thời gian trong SYNTH_MATCH_WINDOW_S
+    struct Score {
+        int truthBounces = 0;
+        int calls = 0;
+        int matched = 0;
+        double precision = 0.0;
+        double recall = 0.0;
+        double contactErrorPx = 0.0;     // Trung bình khoảng cách điểm chạm (ảnh)
+        double contactErrorPxP95 = 0.0;
+        double contactErrorM = 0.0;      // Trung bình trên mặt sân (chỉ call có toạ độ sân)
+        double timingErrorFrames = 0.0;  // Trung bình |frame báo - frame thật|
+        int correctCalls = 0;            // IN / ON LINE khớp IN, OUT khớp OUT
+        int inCalledOut = 0;
+        int outCalledIn = 0;
+        double callAccuracy = 0.0;       // correctCalls / matched
+    };
+
+    explicit SyntheticRally(const Options& options);
+
+    const Options& options() const { return opts; }
+    long frames() const { return frameCount; }
+
+    BallTruth ball(long frameIndex) const;
+    const std::vector<BounceTruth>& bounces() const { return bounceTruth; }
+    // 4 góc sân trong ảnh theo thứ tự CourtModel: gần-trái, gần-phải, xa-phải, xa-trái
+    const std::vector<cv::Point2f>& courtCorners() const { return corners; }
+
+    // Vẽ frame thứ frameIndex vào frame (dùng lại buffer)
+    void render(long frameIndex, cv::Mat& frame) const;
+
+    // Box của các vật giống bóng không phải bóng chính (bóng nhiễu, bóng đổ của bóng chính) ở frame
+    void distractorBoxes(long frameIndex, std::vector<cv::Rect>& out) const;
+
+    Score score(const std::vector<BounceCall>& calls) const;
+
+    // Ground truth dạng JSON Lines: 1 dòng header (kích thước, fps, góc sân) rồi 1 dòng mỗi bounce
+    bool writeTruth(const std::string& path) const;
+
+    cv::Point2f project(const cv::Point3f& courtPt) const;
+
+private:
+    // 1 đoạn bay tự do (chỉ có trọng lực) của bóng chính
+    struct Segment {
+        double t0, t1;
+        cv::Point3f p0, v0;
+    };
+    struct Distractor {
+        cv::Point3f p0;
+        float speed;                // m/s theo x, 0 = đứng yên
+        float minX, maxX;           // Lăn qua lại trong khoảng này
+    };
+
+    Options opts;
+    long frameCount;
+    std::vector<Segment> segments;
+    std::vector<BounceTruth> bounceTruth;
+    std::vector<Distractor> distractors;
+    cv::Scalar shirtColors[2];
+    std::vector<cv::Point2f> corners;
+    cv::Mat background;
+    cv::Scalar shadowColor;     // Mặt sân tối đi
+
+    // Camera: tâm, 3 trục (phải, xuống, trước) và phép chiếu lên pixel
+    cv::Point3f camPos, camRight, camDown, camForward;
+    float focal = 1.0f;
+    cv::Point2f principal;
+
+    void setupCamera();
+    void simulate(cv::RNG& rng);
+    void buildBackground(cv::RNG& rng);
+    bool ballAt(double t, cv::Point3f& pos) const;
+    float pixelRadius(const cv::Point3f& courtPt, float radiusM) const;
+    cv::Point3f distractorAt(const Distractor& d, double t) const;
+    cv::Point3f playerAt(int side, double t) const;
+};
+
+#endif
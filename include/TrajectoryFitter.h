@@ -0,0 +1,92 @@
+#ifndef TRAJECTORY_FITTER_H
+#define TRAJECTORY_FITTER_H
+
+#include <opencv2/opencv.hpp>
+
+// Bình phương tối thiểu đệ quy (RLS) cho p(t) = c0 + c1*t + c2*t^2, mỗi điểm mới cập nhật O(1)
+struct QuadraticRls {
+    double theta[3];
+    double P[3][3];
+
+    // Prior: c0, c1 gần như tự do; c2 quanh c2Prior với phương sai c2Var (nhỏ = giữ độ cong của đoạn trước)
+    void reset(double c2Prior, double c2Var);
+    void update(double t, double value);
+    double eval(double t) const { return theta[0] + (theta[1] + theta[2] * t) * t; }
+    double slope(double t) const { return theta[1] + 2.0 * theta[2] * t; }
+    // Phương sai của eval(t) do sai số tham số (phi^T P phi)
+    double variance(double t) const {
+        const double phi[3] = {1.0, t, t * t};
+        double v = 0.0;
+        for (int i = 0; i < 3; ++i)
+            for (int j = 0; j < 3; ++j) v += phi[i] * P[i][j] * phi[j];
+        return v;
+    }
+};
+
+// Quỹ đạo bóng chính dạng các đoạn parabol nối tiếp (x(t), y(t) bậc 2 theo thời gian, t tính bằng frame).
+// Điểm mới khớp dự đoán của đoạn hiện tại thì được thêm vào RLS; TRAJ_CONFIRM_POINTS điểm liên tiếp lệch
+// khỏi đoạn thì đoạn bị ngắt và đoạn mới bắt đầu (giữ độ cong cũ làm prior vì trọng lực không đổi).
+// Ngắt đoạn có vận tốc dọc bị đẩy lên (vy giảm ít nhất TRAJ_MIN_KICK) là 1 bounce: thời điểm chạm là giao
+// của 2 parabol giữa điểm cuối đoạn cũ và điểm đầu đoạn mới, nên chính xác dưới 1 frame kể cả khi
+// frame chạm đất bị mất hoặc video chỉ 30 fps.
+class TrajectoryFitter {
+public:
+    struct Bounce {
+        double time;     // Thời điểm chạm (frame, cùng trục thời gian với add)
+        cv::Point2f pos; // Tâm bóng lúc chạm
+    };
+
+    void reset();
+
+    // Thêm vị trí bóng chính ở thời điểm t (tăng dần, có thể cách quãng khi mất detection).
+    // Trả về true khi điểm này xác nhận 1 bounce (trễ TRAJ_CONFIRM_POINTS điểm sau lúc chạm).
+    bool add(double t, cv::Point2f pos, Bounce& out);
+
+    long segments() const { return segmentCount; }
+
+private:
+    static const int MAX_PENDING = 4;
+    static const int RECENT = 4; // Số điểm cuối của đoạn có thể trả lại (rollback) khi ngắt đoạn
+
+    struct Segment {
+        double t0 = 0.0;     // Gốc thời gian của RLS
+        double lastT = 0.0;
+        int n = 0;
+        QuadraticRls x, y;
+
+        // Ring các điểm cuối kèm trạng thái RLS trước khi thêm điểm đó
+        struct Sample {
+            double t;
+            cv::Point2f pos;
+            QuadraticRls x, y;
+            double lastT;
+        };
+        Sample recent[RECENT];
+        int recentHead = 0;  // Slot sẽ ghi tiếp
+        int recentCount = 0;
+
+        void start(double origin, const Segment* prior);
+        void add(double t, cv::Point2f p);
+        // Điểm thứ k tính từ cuối (k = 1 là điểm mới nhất)
+        const Sample& fromEnd(int k) const { return recent[(recentHead - k + RECENT) % RECENT]; }
+        // Bỏ k điểm cuối, RLS về trạng thái trước khi thêm chúng
+        void rollback(int k);
+        cv::Point2f eval(double t) const { return cv::Point2f((float)x.eval(t - t0), (float)y.eval(t - t0)); }
+        cv::Point2f velocity(double t) const { return cv::Point2f((float)x.slope(t - t0), (float)y.slope(t - t0)); }
+    };
+
+    bool active = false;
+    Segment current;
+    Segment candidate;
+    // Điểm lệch khỏi đoạn hiện tại đang chờ xác nhận ngắt đoạn
+    double pendingT[MAX_PENDING];
+    cv::Point2f pendingPos[MAX_PENDING];
+    int pendingCount = 0;
+    long segmentCount = 0;
+
+    float tolerance(double t) const;
+    // Thời điểm 2 đoạn giao nhau (theo y) trong [lo, hi]
+    static double contactTime(const Segment& before, const Segment& after, double lo, double hi);
+};
+
+#endif
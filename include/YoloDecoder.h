@@ -0,0 +1,103 @@
+#ifndef YOLO_DECODER_H
+#define YOLO_DECODER_H
+
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <vector>
+
+struct Detection {
+    int class_id;
+    float confidence;
+    cv::Rect box;
+};
+
+// Tham số giải mã output YOLO cho 1 frame
+struct DecodeParams {
+    float confThreshold;  // score >= confThreshold (CONF_THRESHOLD)
+    float scoreThreshold; // score > scoreThreshold (SCORE_THRESHOLD của NMS)
+    float nmsThreshold;   // IoU tối đa giữa 2 box được giữ lại
+    // Chuyển toạ độ network -> frame: frame = net * scale + offset
+    float scaleX, scaleY;
+    float offsetX, offsetY;
+};
+
+// Giải mã output YOLOv8 dạng channel-major [4 + numClasses, anchors] ngay trên tensor gốc:
+// không transpose, chỉ lọc hàng score của class ball (class 0) bằng SIMD (AVX2/NEON, fallback scalar),
+// gom các anchor vượt ngưỡng rồi chạy NMS cho tập nhỏ trong cùng lượt.
+// Buffer tạm được giữ lại giữa các frame nên không cấp phát lại mỗi frame.
+class YoloDecoder {
+public:
+    // Số class cố định lúc compile -> vòng kiểm tra argmax được unroll
+    template <int NumClasses>
+    void decode(const float* output, int anchors, const DecodeParams& params, std::vector<Detection>& out) {
+        static_assert(NumClasses > 0, "NumClasses must be positive");
+        decodeImpl<NumClasses>(output, NumClasses, anchors, params, out);
+    }
+
+    // Bản runtime cho model có số class khác cấu hình
+    void decode(const float* output, int numClasses, int anchors, const DecodeParams& params, std::vector<Detection>& out) {
+        decodeImpl<0>(output, numClasses, anchors, params, out);
+    }
+
+    // Ghi chỉ số các phần tử row[i] >= threshold vào outIdx, trả về số phần tử (SIMD)
+    static int compactAbove(const float* row, int n, float threshold, int* outIdx);
+
+private:
+    std::vector<int> candidates;
+    std::vector<float> scores;
+    std::vector<cv::Rect> boxes;
+    std::vector<int> order;
+
+    // NumClasses = 0: số class lấy từ tham số runtime numClasses
+    template <int NumClasses>
+    void decodeImpl(const float* output, int numClasses, int anchors,
+                    const DecodeParams& params, std::vector<Detection>& out);
+
+    // NMS tham lam trên tập candidate nhỏ, giữ nguyên thứ tự score giảm dần như cv::dnn::NMSBoxes
+    void nms(float nmsThreshold, std::vector<Detection>& out);
+};
+
+template <int NumClasses>
+void YoloDecoder::decodeImpl(const float* output, int numClasses, int anchors,
+                             const DecodeParams& params, std::vector<Detection>& out) {
+    const int classes = NumClasses > 0 ? NumClasses : numClasses;
+    out.clear();
+    candidates.resize(anchors);
+    scores.clear();
+    boxes.clear();
+
+    // Hàng score của class ball nằm ngay sau 4 hàng bbox
+    const float* ballRow = output + 4 * (size_t)anchors;
+    float threshold = std::max(params.confThreshold, params.scoreThreshold);
+    int count = compactAbove(ballRow, anchors, threshold, candidates.data());
+
+    for (int k = 0; k < count; ++k) {
+        int a = candidates[k];
+        float score = ballRow[a];
+        if (score <= params.scoreThreshold) continue;
+
+        // Ball phải là class có score cao nhất (class khác bằng điểm thì class 0 vẫn thắng)
+        bool isArgMax = true;
+        for (int c = 1; c < classes; ++c) {
+            if (ballRow[(size_t)c * anchors + a] > score) {
+                isArgMax = false;
+                break;
+            }
+        }
+        if (!isArgMax) continue;
+
+        float cx = output[a] * params.scaleX + params.offsetX;
+        float cy = output[anchors + a] * params.scaleY + params.offsetY;
+        float w = output[2 * (size_t)anchors + a] * params.scaleX;
+        float h = output[3 * (size_t)anchors + a] * params.scaleY;
+
+        int left = int(cx - w / 2);
+        int top = int(cy - h / 2);
+        boxes.push_back(cv::Rect(left, top, int(w), int(h)));
+        scores.push_back(score);
+    }
+
+    nms(params.nmsThreshold, out);
+}
+
+#endif
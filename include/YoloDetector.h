@@ -4,21 +4,89 @@
 #include <opencv2/opencv.hpp>
 #include <opencv2/dnn.hpp>
 #include <vector>
+#include "YoloDecoder.h"
 
-struct Detection {
-    int class_id;
-    float confidence;
-    cv::Rect box;
-};
+// Độ chính xác khi forward trên CPU. INT8 lượng tử hoá model FP32 lúc load từ các frame calibration
+// (PickleballCalibrate tạo), FP16 chỉ có trên CPU hỗ trợ phép tính FP16 (không thì chạy FP32).
+enum class Precision { FP32, FP16, INT8 };
 
 class YoloDetector {
 public:
+    // Dùng precision mặc định của process (setDefaultPrecision), để mọi detector do Pipeline /
+    // StreamServer / SegmentedRunner tạo ra chạy cùng 1 chế độ
     YoloDetector(const std::string& modelPath);
+    YoloDetector(const std::string& modelPath, Precision precision, const std::string& calibrationDir);
+
+    // Gọi trước khi tạo detector (vd. từ CLI --precision)
+    static void setDefaultPrecision(Precision precision, const std::string& calibrationDir);
+    static bool parsePrecision(const std::string& name, Precision& out);
+    static const char* precisionName(Precision precision);
+    static bool fp16Supported();
+
+    // Precision thực tế (FP32 nếu chế độ yêu cầu không dùng được)
+    Precision precision() const { return activePrecision; }
+    // false khi model có input cố định 640x640 (phát hiện ở lần detectRoi đầu tiên với input khác 640)
+    bool dynamicInput() const { return dynamicInputSupported; }
+
     std::vector<Detection> detect(cv::Mat& frame);
+    // Detect nhiều frame với 1 lần forward (blob N x 3 x 640 x 640), kết quả theo thứ tự frames
+    std::vector<std::vector<Detection>> detectBatch(const std::vector<cv::Mat>& frames);
+    // Detect trên vùng roi của frame với input inputSize x inputSize, box trả về theo toạ độ frame gốc
+    std::vector<Detection> detectRoi(const cv::Mat& frame, const cv::Rect& roi, int inputSize);
+
+    // Các bản ghi kết quả vào vector của caller: giữ capacity giữa các frame nên khi đã chạy ổn định
+    // (blob, output, bảng resize đã cấp phát) không cấp phát thêm
+    void detect(const cv::Mat& frame, std::vector<Detection>& out);
+    void detectBatch(const std::vector<cv::Mat>& frames, std::vector<std::vector<Detection>>& results);
+    void detectRoi(const cv::Mat& frame, const cv::Rect& roi, int inputSize, std::vector<Detection>& out);
+    // Tiled inference: mỗi tile letterbox vào 640x640 (giữ tỉ lệ, không kéo giãn), mọi tile forward chung 1 batch,
+    // kết quả gộp bằng NMS giữa các tile và trả về theo toạ độ frame gốc
+    void detectTiles(const cv::Mat& frame, const std::vector<cv::Rect>& tiles, std::vector<Detection>& out);
+
+    // Các bước của detect() tách riêng để đo thời gian từng bước (benchmark)
+    // Preprocess: resize về inputSize x inputSize, scale 1/255, BGR -> RGB
+    static void preprocess(const cv::Mat& image, cv::Mat& blob, int inputSize);
+    // Forward 1 blob, trả về output [N, channels, anchors]
+    cv::Mat forward(const cv::Mat& blob);
+    // Vị trí ảnh kích thước image trong input inputSize x inputSize khi letterbox (căn giữa, giữ tỉ lệ)
+    static cv::Rect letterboxRect(cv::Size image, int inputSize);
+    // Giải mã output của 1 ảnh region (toạ độ frame gốc) đã preprocess với inputSize
+    std::vector<Detection> decode(const cv::Mat& output, const cv::Rect& region, int inputSize);
+    void decode(const cv::Mat& output, const cv::Rect& region, int inputSize, std::vector<Detection>& out);
 
 private:
     cv::dnn::Net net;
+    Precision activePrecision = Precision::FP32;
     std::vector<std::string> outNames;
+    bool batchSupported = true;
+    bool dynamicInputSupported = true;
+    YoloDecoder decoder;
+
+    // Buffer dùng lại giữa các frame
+    cv::Mat blob;
+    std::vector<cv::Mat> outputs;
+    std::vector<float> batchStorage;       // Blob batch N x 3 x 640 x 640 lớn nhất đã gặp
+    std::vector<cv::Mat> batchHeaders;     // batchHeaders[n]: header blob n frame trỏ vào batchStorage
+    std::vector<std::vector<Detection>> tileResults;
+
+    // Header blob N x 3 x 640 x 640 trên batchStorage (chỉ cấp phát khi N lớn hơn mọi lần trước)
+    cv::Mat& batchBlob(size_t n);
+
+    // Resize bilinear + scale 1/255 + BGR -> RGB planar trong 1 lượt, ghi thẳng vào 3 plane của blob.
+    // Ảnh được vẽ vào vùng placement của input, phần còn lại tô màu pad (letterbox).
+    static void preprocessInto(const cv::Mat& image, float* dst, int inputSize, const cv::Rect& placement);
+
+    // Gộp detection của các tile: box chồng nhau (IoU hoặc bị tile cắt, nằm gọn trong box khác) giữ confidence cao nhất
+    static void mergeTiles(std::vector<Detection>& detections);
+
+    void load(const std::string& modelPath, Precision precision, const std::string& calibrationDir);
+    // Frame calibration INT8 của thư mục (đã preprocess 640), đọc 1 lần cho cả process
+    static const std::vector<cv::Mat>& calibrationSet(const std::string& calibrationDir);
+
+    // Giải mã output [channels, anchors] của ảnh region (toạ độ frame gốc) đã được vẽ vào vùng placement
+    // của input thành danh sách Detection
+    void decodeOutput(const float* output, int channels, int anchors, const cv::Rect& region, const cv::Rect& placement,
+                      std::vector<Detection>& out);
 };
 
 #endif
\ No newline at end of file
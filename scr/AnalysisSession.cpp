@@ -0,0 +1,120 @@
+#include "AnalysisSession.h"
+#include "CourtTiling.h"
+#include "StageMetrics.h"
+
+AnalysisSession::AnalysisSession(ModelPool& models, const SessionOptions& options)
+    : detector(models.acquire()), options(options) {}
+
+AnalysisSession::AnalysisSession(const SessionOptions& options) : options(options) {}
+
+void AnalysisSession::begin(const cv::Mat& firstFrame) {
+    setup(firstFrame, firstFrame.size());
+}
+
+void AnalysisSession::begin(cv::Size frameSize) {
+    setup(cv::Mat(), frameSize);
+}
+
+void AnalysisSession::setup(const cv::Mat& frame, cv::Size frameSize) {
+    begun = true;
+    if (options.hasCourtLine) {
+        line = options.courtLine;
+        lineFound = true;
+    } else if (options.autoCourtLine && !frame.empty()) {
+        lineFound = lineDetector.getLongestLine(frame, line);
+    }
+    outRefPoint = options.hasOutRefPoint ? options.outRefPoint
+                                         : cv::Point2f((float)frameSize.width, frameSize.height / 2.0f);
+    if (lineFound && options.lineTracking && !frame.empty()) lineTracker.init(line);
+
+    // Line của frame đầu chỉ detect 1 lần cho cả mô hình sân và vùng tile
+    std::vector<CourtLine> frameLines;
+    bool needLines = !frame.empty() && ((options.courtModel && options.courtCorners.empty()) || options.tiled);
+    if (needLines) frameLines = lineDetector.detect(frame);
+
+    if (options.courtModel) {
+        if (!options.courtCorners.empty()) courtModel.calibrateCorners(options.courtCorners, frameSize);
+        else if (!frame.empty()) courtModel.calibrate(frameLines, frameSize);
+    }
+
+    if (options.tiled) {
+        cv::Rect region = courtModel.valid() ? CourtTiling::courtRegion(courtModel.corners(), frameSize)
+                                             : CourtTiling::courtRegion(frameLines, frameSize);
+        tileRects = CourtTiling::layout(region, Config::TILE_SIZE, Config::TILE_OVERLAP);
+    }
+}
+
+const TrackResult& AnalysisSession::push(const cv::Mat& frame, double timestampMs) {
+    if (!begun) begin(frame);
+
+    if (tileRects.empty()) detector->detect(frame, detections);
+    else detector->detectTiles(frame, tileRects, detections);
+    track(frame, frameIndex, detections, result);
+
+    if (result.hasBall || result.bounceDetected) {
+        ++eventCount;
+        SessionEvent event{frameIndex, timestampMs, result};
+        if (eventFn) eventFn(event);
+        else pending.push_back(event);
+    }
+    ++frameIndex;
+    METRICS_FRAME_DONE();
+    return result;
+}
+
+bool AnalysisSession::track(const cv::Mat& frame, long index, const std::vector<Detection>& frameDetections,
+                            TrackResult& out) {
+    if (!begun) begin(frame);
+    if (lastTrackedIndex >= 0 && index > lastTrackedIndex + 1) tracker.skipFrames(index - lastTrackedIndex - 1);
+    lastTrackedIndex = index;
+
+    boxes.clear();
+    for (const auto& det : frameDetections) boxes.push_back(det.box);
+    bool hasBall;
+    {
+        METRICS_SCOPE(TRACK);
+        hasBall = tracker.update(boxes, frame, out);
+    }
+    judge(frame, index, hasBall, out);
+    return hasBall;
+}
+
+bool AnalysisSession::track(const std::vector<cv::Rect>& frameBoxes, const std::vector<ColorStats::RoiStats>& stats,
+                            const CourtLine* frameLine, TrackResult& out) {
+    bool hasBall;
+    {
+        METRICS_SCOPE(TRACK);
+        hasBall = tracker.update(frameBoxes, stats, out);
+    }
+    lineFound = frameLine != nullptr;
+    if (frameLine) line = *frameLine;
+    judge(cv::Mat(), -1, hasBall, out);
+    return hasBall;
+}
+
+void AnalysisSession::judge(const cv::Mat& frame, long index, bool hasBall, TrackResult& out) {
+    lineChanged = false;
+    if (lineTracker.valid() && !frame.empty()) {
+        METRICS_SCOPE(LINES);
+        lineChanged = lineTracker.update(frame, index);
+        line = lineTracker.line();
+        // Camera bị dời (line được detect lại thành công trên cả frame) -> calibrate lại sân từ chính các line
+        // đó, raster dựng lại. Góc sân nhập tay thì giữ nguyên.
+        if (lineChanged && lineTracker.redetected() && courtModel.valid() && options.courtCorners.empty()) {
+            courtModel.calibrate(lineTracker.detectedLines(), frame.size());
+        }
+    }
+    if (hasBall && courtModel.valid()) {
+        METRICS_SCOPE(LINES);
+        tracker.processBounce(out, courtModel);
+    } else if (hasBall && lineFound) {
+        METRICS_SCOPE(LINES);
+        tracker.processBounce(out, line.pt1, line.pt2, outRefPoint);
+    }
+}
+
+std::vector<SessionEvent> AnalysisSession::takeEvents() {
+    std::vector<SessionEvent> out;
+    out.swap(pending);
+    return out;
+}
@@ -1,67 +1,33 @@
 #include "BallTracker.h"
 #include "Utils.h"
+#include "Config.h"
 #include <iostream>
+#include <algorithm>
 
-BallTracker::BallTracker() {}
+// Ngưỡng match detection với track và ngưỡng coi là trùng vị trí (pixels), cũng là kích thước ô lưới gate
+static const float MATCH_DIST_THRESHOLD = 250.0f;
+static const float OVERLAP_DIST_THRESHOLD = 30.0f;
 
-// Helper function: Tính độ sáng trung bình trong bbox
-float BallTracker::computeBrightness(const cv::Rect& bbox, const cv::Mat& frame) {
-    // Đảm bảo bbox nằm trong frame
-    cv::Rect valid_bbox = bbox & cv::Rect(0, 0, frame.cols, frame.rows);
-    if (valid_bbox.width <= 0 || valid_bbox.height <= 0) {
-        return 0.0f;
-    }
-    
-    // Lấy ROI
-    cv::Mat roi = frame(valid_bbox);
-    
-    // Convert sang grayscale nếu cần
-    cv::Mat gray;
-    if (roi.channels() == 3) {
-        cv::cvtColor(roi, gray, cv::COLOR_BGR2GRAY);
-    } else {
-        gray = roi;
-    }
-    
-    // Tính mean brightness
-    cv::Scalar mean_val = cv::mean(gray);
-    return static_cast<float>(mean_val[0]);
+BallTracker::BallTracker()
+    : tracks(Config::MAX_TRACKS),
+      kalman_bank(Config::PROCESS_NOISE, Config::MEASUREMENT_NOISE),
+      track_grid(MATCH_DIST_THRESHOLD),
+      prev_grid_1(OVERLAP_DIST_THRESHOLD),
+      prev_grid_2(OVERLAP_DIST_THRESHOLD) {}
+
+// Helper function: Độ sáng trung bình trong bbox (luminance từ kernel thống kê màu)
+float BallTracker::computeBrightness(const ColorStats::RoiStats& stats) {
+    return stats.valid ? stats.gray : 0.0f;
 }
 
-// Helper function: Kiểm tra xem bbox có phải màu đen/xám không
-bool BallTracker::isBlackOrGray(const cv::Rect& bbox, const cv::Mat& frame) {
-    // Đảm bảo bbox nằm trong frame
-    cv::Rect valid_bbox = bbox & cv::Rect(0, 0, frame.cols, frame.rows);
-    if (valid_bbox.width <= 0 || valid_bbox.height <= 0) {
-        return true; // Coi như không hợp lệ
+// Helper function: Kiểm tra xem bbox có phải màu đen/xám không (dựa trên mean S và V của HSV)
+bool BallTracker::isBlackOrGray(const ColorStats::RoiStats& stats) {
+    if (!stats.valid) {
+        return true; // bbox nằm ngoài frame, coi như không hợp lệ
     }
     
-    // Lấy ROI
-    cv::Mat roi = frame(valid_bbox);
-    
-    // Convert sang HSV để kiểm tra saturation (màu sắc)
-    cv::Mat hsv;
-    if (roi.channels() == 3) {
-        cv::cvtColor(roi, hsv, cv::COLOR_BGR2HSV);
-    } else {
-        // Nếu đã là grayscale thì chuyển sang BGR rồi HSV
-        cv::Mat bgr;
-        cv::cvtColor(roi, bgr, cv::COLOR_GRAY2BGR);
-        cv::cvtColor(bgr, hsv, cv::COLOR_BGR2HSV);
-    }
-    
-    // Tách các channel
-    std::vector<cv::Mat> channels;
-    cv::split(hsv, channels);
-    cv::Mat saturation = channels[1]; // S channel (0-255)
-    cv::Mat value = channels[2];        // V channel (brightness, 0-255)
-    
-    // Tính mean saturation và value
-    cv::Scalar mean_sat = cv::mean(saturation);
-    cv::Scalar mean_val = cv::mean(value);
-    
-    float avg_saturation = static_cast<float>(mean_sat[0]);
-    float avg_value = static_cast<float>(mean_val[0]);
+    float avg_saturation = stats.saturation;
+    float avg_value = stats.value;
     
     // Nới lỏng filter để chấp nhận bóng mờ: giảm threshold
     // Nếu saturation thấp (< 20) và value thấp (< 70) thì là đen/xám
@@ -76,139 +42,206 @@ bool BallTracker::isBlackOrGray(const cv::Rect& bbox, const cv::Mat& frame) {
     return false; // Có màu sắc, không phải đen/xám
 }
 
-bool BallTracker::update(const std::vector<cv::Rect>& detections, cv::Mat& frame, cv::Point2f& outCenter) {
-    // 1. Map detections với tracking objects hiện có (Hungarian lite)
-    std::vector<int> used_ids;
-    
-    // Lưu centers của frame hiện tại để dùng cho frame sau
-    std::vector<cv::Point2f> current_frame_centers;
-    
-    for (const auto& box : detections) {
-        // Filter ngay từ đầu: bỏ qua detection màu đen/xám
-        if (isBlackOrGray(box, frame)) {
-            continue; // Bỏ qua detection này
+void BallTracker::associate() {
+    const float dist_threshold = MATCH_DIST_THRESHOLD; // Tăng từ 150 lên 250 để match bóng di chuyển xa hơn
+
+    // Gate: chỉ xét các cặp (detection, track) nằm trong ô lân cận của vị trí Kalman dự đoán
+    gate_points.clear();
+    gate_slots.clear();
+    for (int slot = 0; slot < Config::MAX_TRACKS; ++slot) {
+        if (!tracks[slot].active) continue;
+        gate_points.push_back(kalman_bank.position(slot));
+        gate_slots.push_back(slot);
+    }
+    track_grid.build(gate_points.data(), gate_slots.data(), (int)gate_slots.size());
+
+    gate_pairs.clear();
+    for (int d = 0; d < (int)candidates.size(); ++d) {
+        cv::Point2f center = candidates[d].center;
+        track_grid.forEachNear(center, [&](int slot, cv::Point2f pred) {
+            float dist = cv::norm(center - pred);
+            if (dist < dist_threshold) gate_pairs.push_back({d, slot, dist});
+        });
+    }
+    if (gate_pairs.empty()) return;
+
+    // Ma trận chi phí chỉ gồm các track/detection có ít nhất 1 cặp qua gate
+    std::fill(std::begin(slot_row), std::end(slot_row), -1);
+    det_col.assign(candidates.size(), -1);
+    row_slots.clear();
+    col_dets.clear();
+    for (const auto& pair : gate_pairs) {
+        if (slot_row[pair.slot] == -1) {
+            slot_row[pair.slot] = (int)row_slots.size();
+            row_slots.push_back(pair.slot);
         }
-        
-        cv::Point2f center(box.x + box.width/2.0f, box.y + box.height/2.0f);
-        
-        int matched_id = -1;
-        float min_dist = 10000.0f;
-        float dist_threshold = 250.0f; // Tăng từ 150 lên 250 để match bóng di chuyển xa hơn
-        
-        for (auto& [id, obj] : tracking_objects) {
-            float dist = cv::norm(center - obj.pos);
-            if (dist < min_dist && dist < dist_threshold) {
-                min_dist = dist;
-                matched_id = id;
-            }
+        if (det_col[pair.det] == -1) {
+            det_col[pair.det] = (int)col_dets.size();
+            col_dets.push_back(pair.det);
         }
-        
-        // Tính brightness cho detection hiện tại
-        float brightness = computeBrightness(box, frame);
-        
-        if (matched_id == -1) {
+    }
+
+    // Cặp ngoài gate có chi phí lớn -> Hungarian ưu tiên số cặp hợp lệ, sau đó tổng khoảng cách nhỏ nhất
+    const float no_match_cost = 1e6f;
+    int rows = (int)row_slots.size();
+    int cols = (int)col_dets.size();
+    cost_matrix.assign((size_t)rows * cols, no_match_cost);
+    for (const auto& pair : gate_pairs) {
+        cost_matrix[(size_t)slot_row[pair.slot] * cols + det_col[pair.det]] = pair.dist;
+    }
+
+    assignment.solve(cost_matrix.data(), rows, cols, row_to_col);
+    for (int r = 0; r < rows; ++r) {
+        int c = row_to_col[r];
+        if (c < 0 || cost_matrix[(size_t)r * cols + c] >= dist_threshold) continue;
+        candidates[col_dets[c]].slot = row_slots[r];
+    }
+}
+
+int BallTracker::allocateSlot() {
+    for (int slot = 0; slot < Config::MAX_TRACKS; ++slot) {
+        if (!tracks[slot].active) return slot;
+    }
+    return -1;
+}
+
+void BallTracker::skipFrames(long count) {
+    if (count <= 0) return;
+    frame_clock += count;
+    for (long i = 0; i < count; ++i) kalman_bank.predictAll();
+}
+
+bool BallTracker::update(const std::vector<cv::Rect>& detections, const cv::Mat& frame, TrackResult& result) {
+    // Thống kê màu của mọi bbox tính 1 lượt (đọc mỗi ROI đúng 1 lần)
+    ColorStats::computeBatch(frame, detections, det_stats);
+    return update(detections, det_stats, result);
+}
+
+bool BallTracker::update(const std::vector<cv::Rect>& detections, const std::vector<ColorStats::RoiStats>& stats,
+                         TrackResult& result) {
+    result = TrackResult();
+    ++frame_clock;
+    has_fit_bounce = false;
+
+    // 0. Predict vị trí mọi track cho frame hiện tại
+    kalman_bank.predictAll();
+
+    // 1. Lọc detection: bỏ qua detection màu đen/xám ngay từ đầu
+    candidates.clear();
+    for (size_t i = 0; i < detections.size(); ++i) {
+        if (isBlackOrGray(stats[i])) {
+            continue; // Bỏ qua detection này
+        }
+        const cv::Rect& box = detections[i];
+        Candidate c;
+        c.box = box;
+        c.center = cv::Point2f(box.x + box.width/2.0f, box.y + box.height/2.0f);
+        c.brightness = computeBrightness(stats[i]); // Tính brightness cho detection hiện tại
+        c.slot = -1;
+        candidates.push_back(c);
+    }
+
+    // 2. Gán detection <-> track (gate lưới không gian + Hungarian)
+    associate();
+
+    // Lưới centers của 2 frame trước cho kiểm tra 3 frame trùng nhau
+    const float overlap_threshold = OVERLAP_DIST_THRESHOLD; // Ngưỡng khoảng cách để coi là trùng (pixels)
+    bool has_prev_frames = !prev_frame_centers_1.empty() && !prev_frame_centers_2.empty();
+    if (has_prev_frames) {
+        prev_ids.resize(std::max(prev_frame_centers_1.size(), prev_frame_centers_2.size()));
+        for (size_t i = 0; i < prev_ids.size(); ++i) prev_ids[i] = (int)i;
+        prev_grid_1.build(prev_frame_centers_1.data(), prev_ids.data(), (int)prev_frame_centers_1.size());
+        prev_grid_2.build(prev_frame_centers_2.data(), prev_ids.data(), (int)prev_frame_centers_2.size());
+    }
+
+    // 3. Cập nhật track theo thứ tự detection
+    used_slots.clear();
+    current_frame_centers.clear();
+    for (const auto& c : candidates) {
+        int slot = c.slot;
+
+        if (slot == -1) {
             // Detection mới: Kiểm tra xem có trùng trong 3 frame liên tiếp không
-            float overlap_threshold = 30.0f; // Ngưỡng khoảng cách để coi là trùng (pixels)
-            bool is_stationary = false;
-            
-            // Kiểm tra nếu có đủ 2 frame trước
-            if (prev_frame_centers_1.size() > 0 && prev_frame_centers_2.size() > 0) {
-                // Tìm detection gần nhất trong frame n-1
-                float min_dist_1 = 10000.0f;
-                for (const auto& prev_center : prev_frame_centers_1) {
-                    float dist = cv::norm(center - prev_center);
-                    if (dist < min_dist_1) {
-                        min_dist_1 = dist;
-                    }
-                }
-                
-                // Tìm detection gần nhất trong frame n-2
-                float min_dist_2 = 10000.0f;
-                for (const auto& prev_center : prev_frame_centers_2) {
-                    float dist = cv::norm(center - prev_center);
-                    if (dist < min_dist_2) {
-                        min_dist_2 = dist;
-                    }
-                }
-                
-                // Nếu có detection gần trong cả 2 frame trước -> 3 frame trùng nhau -> không chuyển động
-                if (min_dist_1 < overlap_threshold && min_dist_2 < overlap_threshold) {
-                    is_stationary = true;
-                }
-            }
-            
+            // Nếu có detection gần trong cả 2 frame trước -> 3 frame trùng nhau -> không chuyển động
+            bool is_stationary = has_prev_frames &&
+                                 prev_grid_1.anyWithin(c.center, overlap_threshold) &&
+                                 prev_grid_2.anyWithin(c.center, overlap_threshold);
+
+            // Detection mới nhưng trùng trong 3 frame -> bỏ qua (nhiễu đứng yên)
+            if (is_stationary) continue;
+
             // Chỉ tạo tracking object nếu không phải đứng yên (3 frame trùng)
-            if (!is_stationary) {
-                matched_id = next_id++;
-                tracking_objects[matched_id] = {center, box, 0, 0.0f, brightness};
-            } else {
-                // Detection mới nhưng trùng trong 3 frame -> bỏ qua (nhiễu đứng yên)
-                continue;
-            }
+            slot = allocateSlot();
+            if (slot < 0) continue; // Hết slot (quá MAX_TRACKS track)
+            TrackedObj& obj = tracks[slot];
+            obj.id = next_id++;
+            obj.pos = c.center;
+            obj.bbox = c.box;
+            obj.miss_count = 0;
+            obj.total_dist = 0.0f;
+            obj.avg_brightness = c.brightness;
+            obj.active = true;
+            kalman_bank.init(slot, c.center.x, c.center.y);
         } else {
             // Kiểm tra chuyển động: nếu di chuyển quá ít thì coi như nhiễu, không cập nhật
-            float move_dist = cv::norm(center - tracking_objects[matched_id].pos);
+            TrackedObj& obj = tracks[slot];
+            float move_dist = cv::norm(c.center - obj.pos);
             float min_move_threshold = 2.0f; // Giảm từ 5.0 xuống 2.0 để chấp nhận bóng di chuyển ít hơn (pixels)
-            
+
             if (move_dist >= min_move_threshold) {
-                tracking_objects[matched_id].total_dist += move_dist;
-                tracking_objects[matched_id].pos = center;
-                tracking_objects[matched_id].bbox = box;
-                tracking_objects[matched_id].miss_count = 0;
+                obj.total_dist += move_dist;
+                obj.pos = c.center;
+                obj.bbox = c.box;
+                obj.miss_count = 0;
+                kalman_bank.measure(slot, c.center.x, c.center.y);
                 // Cập nhật brightness (moving average để ổn định)
-                tracking_objects[matched_id].avg_brightness = 
-                    0.7f * tracking_objects[matched_id].avg_brightness + 0.3f * brightness;
+                obj.avg_brightness = 0.7f * obj.avg_brightness + 0.3f * c.brightness;
             } else {
                 // Bóng không chuyển động, không cập nhật vị trí (coi như nhiễu)
                 // Tăng miss_count để logic remove lost objects loại bỏ sớm hơn
-                tracking_objects[matched_id].miss_count++;
-                // Không thêm vào used_ids để logic remove lost objects xử lý
-                matched_id = -1;
+                obj.miss_count++;
+                slot = -1;
             }
         }
-        if (matched_id != -1) {
-            used_ids.push_back(matched_id);
-            current_frame_centers.push_back(center); // Lưu center để dùng cho frame sau
+        if (slot != -1) {
+            tracks[slot].updated = true;
+            used_slots.push_back(slot);
+            current_frame_centers.push_back(c.center); // Lưu center để dùng cho frame sau
         }
     }
-    
-    // Cập nhật lịch sử 2 frame: shift frame n-1 -> n-2, frame hiện tại -> n-1
-    prev_frame_centers_2 = prev_frame_centers_1;
-    prev_frame_centers_1 = current_frame_centers;
-    
+
+    // Correct mọi track có đo lường trong frame này
+    kalman_bank.correctAll();
+
+    // Cập nhật lịch sử 2 frame: shift frame n-1 -> n-2, frame hiện tại -> n-1 (swap, không copy)
+    std::swap(prev_frame_centers_2, prev_frame_centers_1);
+    std::swap(prev_frame_centers_1, current_frame_centers);
+
     // Remove lost objects
-    for (auto it = tracking_objects.begin(); it != tracking_objects.end();) {
-        bool found = false;
-        for (int id : used_ids) if (id == it->first) found = true;
-        
-        if (!found) {
-            it->second.miss_count++;
+    for (int slot = 0; slot < Config::MAX_TRACKS; ++slot) {
+        TrackedObj& obj = tracks[slot];
+        if (!obj.active) continue;
+        if (!obj.updated) {
+            obj.miss_count++;
             // Tăng max_miss để chấp nhận mất bóng vài frame (bóng mờ)
-            int max_miss = (it->second.total_dist < 20.0f) ? 8 : 15; // Tăng từ 5/10 lên 8/15
-            if (it->second.miss_count > max_miss) {
-                it = tracking_objects.erase(it);
-            } else {
-                ++it;
+            int max_miss = (obj.total_dist < 20.0f) ? 8 : 15; // Tăng từ 5/10 lên 8/15
+            if (obj.miss_count > max_miss) {
+                obj.active = false;
+                kalman_bank.remove(slot);
             }
-        } else {
-            ++it;
         }
+        obj.updated = false;
     }
     
     // Tìm Main Ball: Kết hợp total_dist và brightness (filter shadow)
-    // Chỉ xét các bóng đã được cập nhật trong frame hiện tại (có trong used_ids)
+    // Chỉ xét các bóng đã được cập nhật trong frame hiện tại (có trong used_slots)
     // Loại bỏ bóng đứng yên khỏi việc chọn main ball
-    int main_id = -1;
+    int main_slot = -1;
     float max_score = 0;
     float min_brightness_threshold = 50.0f; // Giảm từ 80 xuống 50 để chấp nhận bóng mờ hơn (0-255)
     
-    for (int id : used_ids) {
-        // Chỉ xét bóng có trong used_ids (đã được cập nhật, có chuyển động)
-        if (tracking_objects.find(id) == tracking_objects.end()) {
-            continue;
-        }
-        
-        TrackedObj& obj = tracking_objects[id];
+    for (int slot : used_slots) {
+        const TrackedObj& obj = tracks[slot];
         
         // Loại bỏ object quá tối (shadow)
         if (obj.avg_brightness < min_brightness_threshold) {
@@ -222,14 +255,14 @@ bool BallTracker::update(const std::vector<cv::Rect>& detections, cv::Mat& frame
         
         if (score > max_score) {
             max_score = score;
-            main_id = id;
+            main_slot = slot;
         }
     }
     
     // Kiểm tra total_dist của main ball (không dùng max_score vì đã có brightness factor)
-    float main_total_dist = (main_id != -1) ? tracking_objects[main_id].total_dist : 0.0f;
-    if (main_id != -1 && main_total_dist > 30) { // Giảm từ 50 xuống 30 để chấp nhận bóng mới nhanh hơn
-        TrackedObj& mainBall = tracking_objects[main_id];
+    float main_total_dist = (main_slot != -1) ? tracks[main_slot].total_dist : 0.0f;
+    if (main_slot != -1 && main_total_dist > 30) { // Giảm từ 50 xuống 30 để chấp nhận bóng mới nhanh hơn
+        TrackedObj& mainBall = tracks[main_slot];
         last_ball_size = mainBall.bbox.size();
         
         // Kiểm tra nhảy vị trí bất thường (validation logic) - so sánh với vị trí thực tế
@@ -237,58 +270,117 @@ bool BallTracker::update(const std::vector<cv::Rect>& detections, cv::Mat& frame
              float d = cv::norm(mainBall.pos - position_history.back());
              if (d > 400) { // New ball detected far away
                  position_history.clear();
+                 trajectory.reset();
              }
         }
+        if (mainBall.id != main_track_id) trajectory.reset();
+        if (Config::TRAJECTORY_FIT) {
+            has_fit_bounce = trajectory.add((double)frame_clock, mainBall.pos, fit_bounce);
+        }
 
         // Lưu vị trí thực tế (trung tâm bbox) vào history
-        position_history.push_back(mainBall.pos);
-        if (position_history.size() > 5) position_history.erase(position_history.begin());
+        position_history.push_back(mainBall.pos); // Ring 5 phần tử: tự bỏ vị trí cũ nhất
+
+        main_track_slot = main_slot;
+        main_track_id = mainBall.id;
+        main_lost_frames = 0;
         
         // Dùng vị trí thực tế thay vì predicted
-        outCenter = mainBall.pos;
+        result.hasBall = true;
+        result.trackId = mainBall.id;
+        result.ballPos = mainBall.pos;
+        result.ballBox = mainBall.bbox;
+        result.history = position_history;
         
-        // Vẽ ball history
-        for(const auto& p : position_history) {
-            cv::circle(frame, p, 4, cv::Scalar(0,255,0), -1);
-        }
-        cv::rectangle(frame, mainBall.bbox, cv::Scalar(255,255,255), 2);
-        
-        // Vẽ lại điểm bounce nếu có
+        // Điểm bounce trước đó để vẽ lại
         if (has_bounce_point && bounce_point.x >= 0 && bounce_point.y >= 0) {
-            cv::circle(frame, bounce_point, 7, cv::Scalar(0,0,255), -1); // Điểm đỏ
-            cv::circle(frame, bounce_point, 9, cv::Scalar(0,0,255), 2); // Viền đỏ
+            result.hasBounceMarker = true;
+            result.bounceMarker = bounce_point;
         }
         
         return true;
     }
+
+    // Không thấy bóng chính: Kalman của track tiếp tục dự đoán vài frame rồi bỏ
+    if (main_track_slot != -1 && ++main_lost_frames > Config::ROI_MAX_COAST) {
+        main_track_slot = -1;
+    }
     
     return false;
 }
 
-void BallTracker::processBounce(cv::Mat& frame, cv::Point2f currentPos, cv::Point2f linePt1, cv::Point2f linePt2, cv::Point2f outRefPoint) {
-    if (position_history.size() < 3) return;
+bool BallTracker::predictMainBall(cv::Point2f& outPos, cv::Point2f& outVelocity, cv::Size& outSize) const {
+    if (main_track_slot == -1) return false;
+    // Slot có thể đã bị xoá và cấp lại cho track khác
+    const TrackedObj& obj = tracks[main_track_slot];
+    if (!obj.active || obj.id != main_track_id) return false;
+    outPos = kalman_bank.predicted(main_track_slot);
+    outVelocity = kalman_bank.velocity(main_track_slot);
+    outSize = last_ball_size;
+    return true;
+}
+
+void BallTracker::processBounce(TrackResult& result, cv::Point2f linePt1, cv::Point2f linePt2, cv::Point2f outRefPoint) {
+    cv::Point2f inter;
+    if (!detectBounce(result, inter)) return;
+
+    // CHECK IN/OUT
+    result.verdict = Utils::checkOutIn(linePt1, linePt2, outRefPoint, inter);
+}
+
+void BallTracker::processBounce(TrackResult& result, const CourtModel& court) {
+    cv::Point2f inter;
+    if (!detectBounce(result, inter)) return;
+
+    // 1 lần tra raster: vùng sân + IN/OUT, kèm toạ độ sân (mét)
+    CourtModel::Classification c = court.classify(inter);
+    result.zone = c.zone;
+    result.hasCourtPos = true;
+    result.courtPos = c.courtPos;
+    result.verdict = c.onLine ? "ON LINE" : (c.in ? "IN" : "OUT");
+}
+
+bool BallTracker::detectBounce(TrackResult& result, cv::Point2f& inter) {
+    // Vectors cho debug overlay
+    if (position_history.size() >= 3) {
+        result.hasTrajectory = true;
+        result.trajectory[0] = position_history[position_history.size()-3];
+        result.trajectory[1] = position_history[position_history.size()-2];
+        result.trajectory[2] = result.ballPos;
+    }
+
+    // Bounce từ ngắt đoạn quỹ đạo: điểm chạm nội suy giữa 2 frame, không cần frame chạm đất
+    if (Config::TRAJECTORY_FIT) {
+        if (!has_fit_bounce) return false;
+        inter = fit_bounce.pos;
+        inter.y += last_ball_size.height / 2.0f; // Dịch xuống đáy bóng
+        bounce_point = inter;
+        has_bounce_point = true;
+        result.bounceDetected = true;
+        result.hasBouncePoint = true;
+        result.bouncePoint = inter;
+        result.bounceFrameOffset = (float)(fit_bounce.time - frame_clock);
+        return true;
+    }
+
+    if (position_history.size() < 3) return false;
     
     // Lấy 3 điểm cuối
     cv::Point2f p0 = position_history[position_history.size()-3];
     cv::Point2f p1 = position_history[position_history.size()-2];
-    cv::Point2f p2 = currentPos; // Dùng vị trí thực tế của bóng thay vì predicted
+    cv::Point2f p2 = result.ballPos; // Dùng vị trí thực tế của bóng thay vì predicted
     
     float angle = Utils::computeAngle(p0, p1, p2);
     
-    // Draw vectors for debug
-    cv::arrowedLine(frame, p1, p0, cv::Scalar(200, 220, 100), 2);
-    cv::arrowedLine(frame, p1, p2, cv::Scalar(120, 255, 160), 2);
-    
     if (angle < 150 && !bounce_flag) {
         bounce_flag = true;
-        cv::putText(frame, "BOUNCE DETECTED", cv::Point(50, 100), cv::FONT_HERSHEY_SIMPLEX, 1, cv::Scalar(0,0,255), 2);
+        result.bounceDetected = true;
         
         // Tính điểm chạm đất (intersection)
         // Dùng 2 vector p0-p1 và p2-p3 (nếu có p3) hoặc xấp xỉ tại p1
         // Để chính xác như Python:
         if (position_history.size() >= 4) {
              cv::Point2f p_prev = position_history[position_history.size()-4];
-             cv::Point2f inter;
              // Giao điểm đường p_prev->p0 và p1->p2 (đại diện cho quỹ đạo xuống và lên)
              if (Utils::lineIntersection(p_prev, p1, p1, p2, inter)) {
                  // Dịch xuống đáy bóng
@@ -297,17 +389,13 @@ void BallTracker::processBounce(cv::Mat& frame, cv::Point2f currentPos, cv::Poin
                  // Lưu điểm bounce để vẽ lại ở các frame sau
                  bounce_point = inter;
                  has_bounce_point = true;
-                 
-                 // Vẽ điểm bounce đỏ rõ ràng
-                 cv::circle(frame, inter, 7, cv::Scalar(0,0,255), -1); // Điểm đỏ
-                 
-                 
-                 // CHECK IN/OUT
-                 std::string result = Utils::checkOutIn(linePt1, linePt2, outRefPoint, inter);
-                 cv::putText(frame, result, cv::Point(frame.cols - 200, 100), cv::FONT_HERSHEY_SIMPLEX, 2, cv::Scalar(0,255,255), 3);
+                 result.hasBouncePoint = true;
+                 result.bouncePoint = inter;
+                 return true;
              }
         }
     } else if (angle >= 150) {
         bounce_flag = false;
     }
-}
\ No newline at end of file
+    return false;
+}
@@ -0,0 +1,128 @@
+#include "CadenceScheduler.h"
+#include "BallTracker.h"
+#include "Utils.h"
+#include "Config.h"
+#include <algorithm>
+#include <cmath>
+
+// Khoảng cách từ p tới đoạn thẳng a-b
+static float segmentDistance(cv::Point2f p, cv::Point2f a, cv::Point2f b) {
+    cv::Point2f ab = b - a;
+    float len2 = ab.x * ab.x + ab.y * ab.y;
+    float t = len2 > 0.0f ? ((p - a).x * ab.x + (p - a).y * ab.y) / len2 : 0.0f;
+    t = std::max(0.0f, std::min(1.0f, t));
+    cv::Point2f d = p - (a + ab * t);
+    return std::sqrt(d.x * d.x + d.y * d.y);
+}
+
+CadenceScheduler::CadenceScheduler() {}
+
+void CadenceScheduler::setCourtLine(const CourtLine& courtLine) {
+    line = courtLine;
+    hasLine = true;
+}
+
+bool CadenceScheduler::nearLine(cv::Point2f pos, cv::Point2f velocity) const {
+    if (!hasLine) return false;
+    for (int t = 0; t <= Config::CADENCE_MAX_INTERVAL; ++t) {
+        if (segmentDistance(pos + velocity * (float)t, line.pt1, line.pt2) < Config::CADENCE_LINE_MARGIN) return true;
+    }
+    return false;
+}
+
+bool CadenceScheduler::trackOnly(const cv::Mat& frame, long frameIndex, const BallTracker& tracker,
+                                 std::vector<Detection>& out) {
+    if (forceKey || denseHold > 0 || templ.empty() || frameIndex - lastKeyIndex >= k) return false;
+
+    cv::Point2f pos, velocity;
+    cv::Size ballSize;
+    if (!tracker.predictMainBall(pos, velocity, ballSize)) return false;
+
+    // Cửa sổ tìm quanh vị trí dự đoán, nới theo sai số Kalman ~ kích thước bóng và vận tốc
+    float speed = std::sqrt(velocity.x * velocity.x + velocity.y * velocity.y);
+    int half = (int)(Config::CADENCE_SEARCH_SCALE * std::max(templ.cols, templ.rows) + 0.5f * speed);
+    cv::Rect window((int)pos.x - half, (int)pos.y - half, 2 * half, 2 * half);
+    window &= cv::Rect(0, 0, frame.cols, frame.rows);
+    if (window.width < templ.cols || window.height < templ.rows) return false;
+
+    if (frame.channels() == 3) {
+        cv::cvtColor(frame(window), searchGray, cv::COLOR_BGR2GRAY);
+    } else {
+        frame(window).copyTo(searchGray);
+    }
+    cv::matchTemplate(searchGray, templ, matchScores, cv::TM_CCOEFF_NORMED);
+    double bestScore;
+    cv::Point best;
+    cv::minMaxLoc(matchScores, nullptr, &bestScore, nullptr, &best);
+
+    // Patch không còn giống bóng (che khuất, blur mạnh, bóng đổi hướng ra khỏi cửa sổ) -> key frame ngay
+    if (bestScore < Config::CADENCE_MIN_MATCH) {
+        k = 1;
+        return false;
+    }
+
+    Detection det;
+    det.class_id = 0;
+    det.confidence = (float)bestScore;
+    det.box = cv::Rect(window.x + best.x, window.y + best.y, templ.cols, templ.rows);
+    out.clear();
+    out.push_back(det);
+    ++trackCount;
+    return true;
+}
+
+void CadenceScheduler::keyFrame(long frameIndex, const std::vector<Detection>& detections) {
+    lastKeyIndex = frameIndex;
+    lastKeyConf = 0.0f;
+    for (const auto& det : detections) lastKeyConf = std::max(lastKeyConf, det.confidence);
+    forceKey = false;
+    ++keyCount;
+}
+
+void CadenceScheduler::observe(const cv::Mat& frame, long frameIndex, const TrackResult& result) {
+    if (denseHold > 0) --denseHold;
+
+    if (!result.hasBall) {
+        // Mất bóng chính: detect mỗi frame tới khi bắt lại
+        k = 1;
+        forceKey = true;
+        return;
+    }
+
+    // Patch chỉ lấy từ key frame (box của YOLO) để template không trôi theo sai số matching
+    if (frameIndex == lastKeyIndex) {
+        cv::Rect box = result.ballBox & cv::Rect(0, 0, frame.cols, frame.rows);
+        if (box.width >= 4 && box.height >= 4) {
+            cv::Mat patch = frame(box);
+            if (patch.channels() == 3) {
+                cv::cvtColor(patch, templ, cv::COLOR_BGR2GRAY);
+            } else {
+                patch.copyTo(templ);
+            }
+        }
+    }
+
+    bool dense = false;
+    if (result.bounceDetected) {
+        denseHold = Config::CADENCE_BOUNCE_HOLD;
+        dense = true;
+    }
+    if (frameIndex == lastKeyIndex && lastKeyConf < Config::CADENCE_MIN_CONF) dense = true;
+
+    const auto& h = result.history;
+    cv::Point2f velocity(0.0f, 0.0f);
+    if (h.size() >= 2) velocity = h[h.size() - 1] - h[h.size() - 2];
+    if (h.size() >= 3) {
+        // computeAngle = 180 khi bay thẳng
+        float turn = 180.0f - Utils::computeAngle(h[h.size() - 3], h[h.size() - 2], h[h.size() - 1]);
+        if (turn > Config::CADENCE_TURN_DEG) dense = true;
+    }
+    if (nearLine(result.ballPos, velocity)) dense = true;
+
+    // Tăng 1 sau mỗi key frame ổn định, về 1 ngay khi có dấu hiệu cần vị trí dày
+    if (dense) {
+        k = 1;
+    } else if (frameIndex == lastKeyIndex) {
+        k = std::min(k + 1, Config::CADENCE_MAX_INTERVAL);
+    }
+}
@@ -0,0 +1,115 @@
+#include "ClipRecorder.h"
+#include "StageMetrics.h"
+#include <filesystem>
+#include <iostream>
+
+ClipRecorder::ClipRecorder(const std::string& directory, double fps, int preRollFrames, int postRollFrames,
+                           int maxClipFrames, size_t maxPendingClips)
+    : directory(directory), fps(fps > 0.0 ? fps : 30.0), preRoll(std::max(0, preRollFrames)),
+      postRoll(std::max(0, postRollFrames)), maxClipFrames(std::max(1, maxClipFrames)),
+      ring(preRoll), ringIndex(preRoll, -1), pending(maxPendingClips) {
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    encoder = std::thread(&ClipRecorder::encodeLoop, this);
+}
+
+ClipRecorder::~ClipRecorder() {
+    finish();
+}
+
+cv::Mat ClipRecorder::acquire() {
+    std::lock_guard<std::mutex> lock(poolMtx);
+    if (pool.empty()) return cv::Mat(); // copyTo sẽ cấp phát, về sau được dùng lại
+    cv::Mat m = std::move(pool.back());
+    pool.pop_back();
+    return m;
+}
+
+void ClipRecorder::push(const cv::Mat& frame, long frameIndex, bool trigger) {
+    if (finished || frame.empty()) return;
+
+    if (!recording && trigger) {
+        // Chuyển nguyên các slot ring sang clip (không copy), slot ring lấy buffer mới từ pool
+        recording = true;
+        current = Clip();
+        current.eventFrame = frameIndex;
+        current.frames.reserve(ringCount + 1 + postRoll);
+        for (int i = 0; i < ringCount; ++i) {
+            int slot = (ringHead + i) % preRoll;
+            if (current.firstFrame < 0) current.firstFrame = ringIndex[slot];
+            current.frames.push_back(std::move(ring[slot]));
+            ring[slot] = acquire();
+        }
+        ringCount = 0;
+        ringHead = 0;
+        if (current.firstFrame < 0) current.firstFrame = frameIndex;
+        remainingPost = postRoll;
+    } else if (recording && trigger) {
+        remainingPost = postRoll; // Bounce mới trong post-roll -> kéo dài clip
+    }
+
+    if (recording) {
+        cv::Mat copy = acquire();
+        frame.copyTo(copy);
+        current.frames.push_back(std::move(copy));
+        if (!trigger) --remainingPost;
+        if (remainingPost <= 0 || (int)current.frames.size() >= maxClipFrames) closeClip();
+        return;
+    }
+
+    // Không ghi clip: frame vào ring, đè lên slot cũ nhất (cùng kích thước -> không cấp phát lại)
+    if (preRoll == 0) return;
+    int slot;
+    if (ringCount < preRoll) {
+        slot = (ringHead + ringCount) % preRoll;
+        ++ringCount;
+    } else {
+        slot = ringHead;
+        ringHead = (ringHead + 1) % preRoll;
+    }
+    frame.copyTo(ring[slot]);
+    ringIndex[slot] = frameIndex;
+}
+
+void ClipRecorder::closeClip() {
+    recording = false;
+    remainingPost = 0;
+    pending.push(std::move(current)); // Chặn khi encoder tụt lại quá maxPendingClips clip
+    current = Clip();
+}
+
+void ClipRecorder::finish() {
+    if (finished) return;
+    finished = true;
+    if (recording) closeClip();
+    pending.close();
+    if (encoder.joinable()) encoder.join();
+}
+
+void ClipRecorder::encodeLoop() {
+    Clip clip;
+    while (pending.pop(clip)) {
+        if (clip.frames.empty()) continue;
+        std::string path = directory + "/clip_" + std::to_string(clip.eventFrame) + ".mp4";
+        cv::VideoWriter writer(path, cv::VideoWriter::fourcc('m','p','4','v'), fps, clip.frames[0].size());
+        if (writer.isOpened()) {
+            METRICS_SCOPE(WRITE);
+            for (const auto& f : clip.frames) writer.write(f);
+            writer.release();
+            ++written;
+            writtenFrames += (long)clip.frames.size();
+            std::cout << "Clip " << path << " (frames " << clip.firstFrame << "-"
+                      << clip.firstFrame + (long)clip.frames.size() - 1 << ")" << std::endl;
+        } else {
+            std::cerr << "Cannot open clip " << path << std::endl;
+        }
+
+        // Trả buffer về pool, giữ tối đa đủ cho 1 clip dài nhất để bộ nhớ không phình
+        std::lock_guard<std::mutex> lock(poolMtx);
+        for (auto& f : clip.frames) {
+            if (pool.size() >= (size_t)(maxClipFrames + preRoll)) break;
+            pool.push_back(std::move(f));
+        }
+        clip.frames.clear();
+    }
+}
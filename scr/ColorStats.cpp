@@ -0,0 +1,151 @@
+#include "ColorStats.h"
+#include <algorithm>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace ColorStats {
+
+// Hệ số fixed-point của cvtColor BGR2GRAY: (B*1868 + G*9617 + R*4899 + 2^13) >> 14
+static const int GRAY_B = 1868;
+static const int GRAY_G = 9617;
+static const int GRAY_R = 4899;
+static const int GRAY_SHIFT = 14;
+// S = ((V - min) * round((255 << 12) / V) + 2^11) >> 12, cùng bảng chia với cvtColor BGR2HSV 8-bit
+static const int SAT_SHIFT = 12;
+
+struct SatDivTable {
+    alignas(32) int div[256];
+    SatDivTable() {
+        div[0] = 0;
+        for (int v = 1; v < 256; ++v) div[v] = cvRound((255 << SAT_SHIFT) / (double)v);
+    }
+};
+static const SatDivTable satDiv;
+
+// Số pixel mỗi lần tách kênh BGR sang buffer planar trên stack
+static const int CHUNK = 64;
+
+struct Sums {
+    uint64_t gray = 0;
+    uint64_t sat = 0;
+    uint64_t val = 0;
+};
+
+static inline void accumulateScalar(const uint8_t* b, const uint8_t* g, const uint8_t* r, int n, Sums& sums) {
+    for (int i = 0; i < n; ++i) {
+        int v = std::max(b[i], std::max(g[i], r[i]));
+        int mn = std::min(b[i], std::min(g[i], r[i]));
+        int sdiv = satDiv.div[v];
+        sums.gray += (uint32_t)((b[i] * GRAY_B + g[i] * GRAY_G + r[i] * GRAY_R + (1 << (GRAY_SHIFT - 1))) >> GRAY_SHIFT);
+        sums.sat += (uint32_t)(((v - mn) * sdiv + (1 << (SAT_SHIFT - 1))) >> SAT_SHIFT);
+        sums.val += (uint32_t)v;
+    }
+}
+
+#if defined(__AVX2__)
+static inline uint64_t horizontalSum(__m256i v) {
+    alignas(32) uint32_t lanes[8];
+    _mm256_store_si256((__m256i*)lanes, v);
+    uint64_t s = 0;
+    for (int i = 0; i < 8; ++i) s += lanes[i];
+    return s;
+}
+#endif
+
+// Cộng dồn gray/S/V cho n pixel planar
+static inline void accumulate(const uint8_t* b, const uint8_t* g, const uint8_t* r, int n, Sums& sums) {
+    int i = 0;
+#if defined(__AVX2__)
+    const __m256i wb = _mm256_set1_epi32(GRAY_B);
+    const __m256i wg = _mm256_set1_epi32(GRAY_G);
+    const __m256i wr = _mm256_set1_epi32(GRAY_R);
+    const __m256i grayRound = _mm256_set1_epi32(1 << (GRAY_SHIFT - 1));
+    const __m256i satRound = _mm256_set1_epi32(1 << (SAT_SHIFT - 1));
+    __m256i accGray = _mm256_setzero_si256();
+    __m256i accSat = _mm256_setzero_si256();
+    __m256i accVal = _mm256_setzero_si256();
+    for (; i + 8 <= n; i += 8) {
+        __m256i vb = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(b + i)));
+        __m256i vg = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(g + i)));
+        __m256i vr = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(r + i)));
+
+        __m256i gray = _mm256_add_epi32(_mm256_mullo_epi32(vb, wb), _mm256_mullo_epi32(vg, wg));
+        gray = _mm256_add_epi32(gray, _mm256_add_epi32(_mm256_mullo_epi32(vr, wr), grayRound));
+        accGray = _mm256_add_epi32(accGray, _mm256_srli_epi32(gray, GRAY_SHIFT));
+
+        __m256i v = _mm256_max_epi32(vb, _mm256_max_epi32(vg, vr));
+        __m256i mn = _mm256_min_epi32(vb, _mm256_min_epi32(vg, vr));
+        __m256i sdiv = _mm256_i32gather_epi32(satDiv.div, v, 4);
+        __m256i sat = _mm256_mullo_epi32(_mm256_sub_epi32(v, mn), sdiv);
+        accSat = _mm256_add_epi32(accSat, _mm256_srli_epi32(_mm256_add_epi32(sat, satRound), SAT_SHIFT));
+        accVal = _mm256_add_epi32(accVal, v);
+    }
+    sums.gray += horizontalSum(accGray);
+    sums.sat += horizontalSum(accSat);
+    sums.val += horizontalSum(accVal);
+#endif
+    accumulateScalar(b + i, g + i, r + i, n - i, sums);
+}
+
+RoiStats compute(const cv::Mat& frame, const cv::Rect& bbox) {
+    RoiStats stats;
+    // Đảm bảo bbox nằm trong frame
+    cv::Rect roi = bbox & cv::Rect(0, 0, frame.cols, frame.rows);
+    if (roi.width <= 0 || roi.height <= 0) return stats;
+
+    if (frame.depth() != CV_8U || (frame.channels() != 3 && frame.channels() != 1)) {
+        // Định dạng hiếm gặp: đưa về BGR 8-bit rồi tính như bình thường
+        cv::Mat bgr;
+        frame(roi).convertTo(bgr, CV_8U);
+        if (bgr.channels() == 4) cv::cvtColor(bgr, bgr, cv::COLOR_BGRA2BGR);
+        if (bgr.channels() != 3 && bgr.channels() != 1) return stats;
+        return compute(bgr, cv::Rect(0, 0, bgr.cols, bgr.rows));
+    }
+
+    Sums sums;
+    if (frame.channels() == 1) {
+        // Gray -> BGR có B = G = R: S = 0, V = gray
+        for (int y = roi.y; y < roi.y + roi.height; ++y) {
+            const uint8_t* row = frame.ptr<uint8_t>(y) + roi.x;
+            uint64_t s = 0;
+            for (int x = 0; x < roi.width; ++x) s += row[x];
+            sums.gray += s;
+            sums.val += s;
+        }
+    } else {
+        alignas(32) uint8_t b[CHUNK], g[CHUNK], r[CHUNK];
+        for (int y = roi.y; y < roi.y + roi.height; ++y) {
+            const uint8_t* row = frame.ptr<uint8_t>(y) + 3 * roi.x;
+            for (int x = 0; x < roi.width; x += CHUNK) {
+                int n = std::min(CHUNK, roi.width - x);
+                const uint8_t* px = row + 3 * x;
+                // Tách kênh BGR xen kẽ sang buffer planar trên stack
+                for (int i = 0; i < n; ++i) {
+                    b[i] = px[3 * i];
+                    g[i] = px[3 * i + 1];
+                    r[i] = px[3 * i + 2];
+                }
+                accumulate(b, g, r, n, sums);
+            }
+        }
+    }
+
+    float count = (float)roi.area();
+    stats.gray = (float)((double)sums.gray / count);
+    stats.saturation = (float)((double)sums.sat / count);
+    stats.value = (float)((double)sums.val / count);
+    stats.valid = true;
+    return stats;
+}
+
+void computeBatch(const cv::Mat& frame, const std::vector<cv::Rect>& boxes, std::vector<RoiStats>& out) {
+    out.resize(boxes.size());
+    for (size_t i = 0; i < boxes.size(); ++i) {
+        out[i] = compute(frame, boxes[i]);
+    }
+}
+
+}
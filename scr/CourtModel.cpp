@@ -0,0 +1,157 @@
+#include "CourtModel.h"
+#include "Utils.h"
+#include "Config.h"
+#include <algorithm>
+#include <cmath>
+
+CourtModel::CourtModel() {}
+
+const char* CourtModel::zoneName(int zone) {
+    static const char* names[ZONE_COUNT] = {
+        "OUT", "NEAR_LEFT", "NEAR_RIGHT", "NEAR_KITCHEN", "FAR_KITCHEN", "FAR_LEFT", "FAR_RIGHT"
+    };
+    return (zone >= 0 && zone < ZONE_COUNT) ? names[zone] : "UNKNOWN";
+}
+
+void CourtModel::buildCourtLabels() {
+    const float res = Config::COURT_RASTER_CM / 100.0f; // mét / pixel
+    auto px = [res](float meters) { return (int)std::lround(meters / res); };
+    // Hình chữ nhật [x0, x1) x [y0, y1) theo mét
+    auto rect = [&](float x0, float y0, float x1, float y1) {
+        return cv::Rect(px(x0), px(y0), std::max(1, px(x1) - px(x0)), std::max(1, px(y1) - px(y0)));
+    };
+
+    const float half = LENGTH / 2.0f;
+    const float kitchenNear = half - KITCHEN_DEPTH;
+    const float kitchenFar = half + KITCHEN_DEPTH;
+    const float mid = WIDTH / 2.0f;
+
+    courtLabels.create(px(LENGTH), px(WIDTH), CV_8U);
+    courtLabels.setTo(cv::Scalar(ZONE_OUT));
+    courtLabels(rect(0, 0, mid, kitchenNear)).setTo(cv::Scalar(ZONE_NEAR_LEFT));
+    courtLabels(rect(mid, 0, WIDTH, kitchenNear)).setTo(cv::Scalar(ZONE_NEAR_RIGHT));
+    courtLabels(rect(0, kitchenNear, WIDTH, half)).setTo(cv::Scalar(ZONE_NEAR_KITCHEN));
+    courtLabels(rect(0, half, WIDTH, kitchenFar)).setTo(cv::Scalar(ZONE_FAR_KITCHEN));
+    courtLabels(rect(0, kitchenFar, mid, LENGTH)).setTo(cv::Scalar(ZONE_FAR_LEFT));
+    courtLabels(rect(mid, kitchenFar, WIDTH, LENGTH)).setTo(cv::Scalar(ZONE_FAR_RIGHT));
+
+    // Vạch nằm trong kích thước sân và thuộc vùng chứa nó (bóng chạm vạch biên là IN,
+    // chạm kitchen line là kitchen) -> chỉ bật thêm bit ON_LINE
+    const float lw = LINE_WIDTH;
+    const cv::Rect lines[] = {
+        rect(0, 0, WIDTH, lw),                           // Baseline gần
+        rect(0, LENGTH - lw, WIDTH, LENGTH),             // Baseline xa
+        rect(0, 0, lw, LENGTH),                          // Sideline trái
+        rect(WIDTH - lw, 0, WIDTH, LENGTH),              // Sideline phải
+        rect(0, kitchenNear, WIDTH, kitchenNear + lw),   // Kitchen line gần
+        rect(0, kitchenFar - lw, WIDTH, kitchenFar),     // Kitchen line xa
+        rect(mid - lw / 2, 0, mid + lw / 2, kitchenNear),      // Center line gần
+        rect(mid - lw / 2, kitchenFar, mid + lw / 2, LENGTH),  // Center line xa
+    };
+    const cv::Rect bounds(0, 0, courtLabels.cols, courtLabels.rows);
+    for (const auto& r : lines) {
+        cv::Mat roi = courtLabels(r & bounds);
+        cv::bitwise_or(roi, cv::Scalar(ON_LINE), roi);
+    }
+}
+
+void CourtModel::buildRaster(cv::Size frameSize) {
+    if (courtLabels.empty()) buildCourtLabels();
+
+    // pixel nhãn -> mét -> pixel ảnh -> pixel raster
+    const double res = Config::COURT_RASTER_CM / 100.0;
+    const double down = 1.0 / Config::COURT_RASTER_DOWNSCALE;
+    cv::Matx33d labelToCourt(res, 0, 0,
+                             0, res, 0,
+                             0, 0, 1);
+    cv::Matx33d imageToRaster(down, 0, 0,
+                              0, down, 0,
+                              0, 0, 1);
+    cv::Matx33d labelToRaster = imageToRaster * courtToImage * labelToCourt;
+
+    cv::Size rasterSize((frameSize.width + Config::COURT_RASTER_DOWNSCALE - 1) / Config::COURT_RASTER_DOWNSCALE,
+                        (frameSize.height + Config::COURT_RASTER_DOWNSCALE - 1) / Config::COURT_RASTER_DOWNSCALE);
+    cv::warpPerspective(courtLabels, raster, cv::Mat(labelToRaster), rasterSize,
+                        cv::INTER_NEAREST, cv::BORDER_CONSTANT, cv::Scalar(ZONE_OUT));
+    ++rasterVersion;
+}
+
+bool CourtModel::calibrateCorners(const std::vector<cv::Point2f>& corners, cv::Size frameSize) {
+    if (corners.size() != 4) return false;
+    // Tứ giác phải lồi và không suy biến
+    if (!cv::isContourConvex(corners) || cv::contourArea(corners) < 0.01 * frameSize.area()) return false;
+
+    const cv::Point2f court[4] = {
+        cv::Point2f(0, 0), cv::Point2f(WIDTH, 0), cv::Point2f(WIDTH, LENGTH), cv::Point2f(0, LENGTH)
+    };
+    cv::Mat H = cv::getPerspectiveTransform(court, corners.data());
+    courtToImage = cv::Matx33d((const double*)H.ptr<double>());
+    imageToCourt = courtToImage.inv();
+    imageCorners = corners;
+    calibrated = true;
+    buildRaster(frameSize);
+    return true;
+}
+
+bool CourtModel::calibrate(const std::vector<CourtLine>& lines, cv::Size frameSize) {
+    // Chia line thành 2 họ: gần ngang (baseline, kitchen line) và dọc (sideline, center line)
+    const float tanMax = std::tan(Config::COURT_HORIZONTAL_MAX_DEG * (float)CV_PI / 180.0f);
+    const CourtLine* nearBase = nullptr;
+    const CourtLine* farBase = nullptr;
+    const CourtLine* leftSide = nullptr;
+    const CourtLine* rightSide = nullptr;
+    float nearY = -1e9f, farY = 1e9f, leftX = 1e9f, rightX = -1e9f;
+    const float cx = frameSize.width / 2.0f;
+    const float cy = frameSize.height / 2.0f;
+
+    for (const auto& l : lines) {
+        cv::Point2f d = l.pt2 - l.pt1;
+        if (std::fabs(d.y) <= std::fabs(d.x) * tanMax) {
+            // y của line tại giữa frame theo chiều ngang
+            float y = l.pt1.y + d.y * (cx - l.pt1.x) / d.x;
+            if (y > nearY) { nearY = y; nearBase = &l; }
+            if (y < farY) { farY = y; farBase = &l; }
+        } else if (std::fabs(d.y) > 1e-3f) {
+            float x = l.pt1.x + d.x * (cy - l.pt1.y) / d.y;
+            if (x < leftX) { leftX = x; leftSide = &l; }
+            if (x > rightX) { rightX = x; rightSide = &l; }
+        }
+    }
+    if (!nearBase || !leftSide || nearBase == farBase || leftSide == rightSide) return false;
+    if (nearY - farY < 0.1f * frameSize.height || rightX - leftX < 0.1f * frameSize.width) return false;
+
+    cv::Point2f corners[4];
+    const CourtLine* pairs[4][2] = {
+        {nearBase, leftSide}, {nearBase, rightSide}, {farBase, rightSide}, {farBase, leftSide}
+    };
+    for (int i = 0; i < 4; ++i) {
+        if (!Utils::lineIntersection(pairs[i][0]->pt1, pairs[i][0]->pt2, pairs[i][1]->pt1, pairs[i][1]->pt2, corners[i])) {
+            return false;
+        }
+    }
+    return calibrateCorners(std::vector<cv::Point2f>(corners, corners + 4), frameSize);
+}
+
+cv::Point2f CourtModel::toCourt(cv::Point2f p) const {
+    const cv::Matx33d& m = imageToCourt;
+    double w = m(2, 0) * p.x + m(2, 1) * p.y + m(2, 2);
+    if (std::fabs(w) < 1e-12) return cv::Point2f(-1, -1);
+    return cv::Point2f((float)((m(0, 0) * p.x + m(0, 1) * p.y + m(0, 2)) / w),
+                       (float)((m(1, 0) * p.x + m(1, 1) * p.y + m(1, 2)) / w));
+}
+
+CourtModel::Classification CourtModel::classify(cv::Point2f imagePt) const {
+    Classification c;
+    if (!calibrated) return c;
+
+    int rx = (int)(imagePt.x / Config::COURT_RASTER_DOWNSCALE);
+    int ry = (int)(imagePt.y / Config::COURT_RASTER_DOWNSCALE);
+    if (imagePt.x >= 0 && imagePt.y >= 0 && rx < raster.cols && ry < raster.rows) {
+        unsigned char label = raster.at<unsigned char>(ry, rx);
+        c.zone = label & ~ON_LINE;
+        c.onLine = (label & ON_LINE) != 0;
+    }
+    c.in = c.zone != ZONE_OUT;
+    c.courtPos = toCourt(imagePt);
+    return c;
+}
@@ -0,0 +1,79 @@
+#include "CourtTiling.h"
+#include "Config.h"
+#include <algorithm>
+#include <cmath>
+
+namespace CourtTiling {
+
+namespace {
+    cv::Rect padRegion(float minX, float minY, float maxX, float maxY, cv::Size frameSize) {
+        float w = maxX - minX;
+        float h = maxY - minY;
+        float x0 = minX - Config::TILE_COURT_MARGIN * w;
+        float x1 = maxX + Config::TILE_COURT_MARGIN * w;
+        float y0 = minY - Config::TILE_COURT_MARGIN_TOP * h;
+        float y1 = maxY + Config::TILE_COURT_MARGIN * h;
+        cv::Rect region((int)std::floor(x0), (int)std::floor(y0),
+                        (int)std::ceil(x1 - x0), (int)std::ceil(y1 - y0));
+        return region & cv::Rect(0, 0, frameSize.width, frameSize.height);
+    }
+
+    // Vị trí bắt đầu các đoạn dài tile trên [start, start + length), chia đều, chồng >= overlap
+    void splitAxis(int start, int length, int tile, int overlap, std::vector<int>& starts, int& size) {
+        starts.clear();
+        if (length <= tile) {
+            starts.push_back(start);
+            size = length;
+            return;
+        }
+        int stride = std::max(1, tile - overlap);
+        int count = (int)std::ceil((double)(length - overlap) / stride);
+        count = std::max(count, 2);
+        for (int i = 0; i < count; ++i) {
+            starts.push_back(start + (int)std::lround((double)i * (length - tile) / (count - 1)));
+        }
+        size = tile;
+    }
+}
+
+cv::Rect courtRegion(const std::vector<CourtLine>& lines, cv::Size frameSize) {
+    if (lines.empty()) return cv::Rect();
+    float minX = lines[0].pt1.x, maxX = minX, minY = lines[0].pt1.y, maxY = minY;
+    for (const auto& line : lines) {
+        for (const cv::Point2f& p : {line.pt1, line.pt2}) {
+            minX = std::min(minX, p.x);
+            maxX = std::max(maxX, p.x);
+            minY = std::min(minY, p.y);
+            maxY = std::max(maxY, p.y);
+        }
+    }
+    return padRegion(minX, minY, maxX, maxY, frameSize);
+}
+
+cv::Rect courtRegion(const std::vector<cv::Point2f>& corners, cv::Size frameSize) {
+    if (corners.empty()) return cv::Rect();
+    float minX = corners[0].x, maxX = minX, minY = corners[0].y, maxY = minY;
+    for (const cv::Point2f& p : corners) {
+        minX = std::min(minX, p.x);
+        maxX = std::max(maxX, p.x);
+        minY = std::min(minY, p.y);
+        maxY = std::max(maxY, p.y);
+    }
+    return padRegion(minX, minY, maxX, maxY, frameSize);
+}
+
+std::vector<cv::Rect> layout(const cv::Rect& region, int tileSize, int overlap) {
+    std::vector<cv::Rect> tiles;
+    if (region.width <= 0 || region.height <= 0) return tiles;
+
+    std::vector<int> xs, ys;
+    int tileW, tileH;
+    splitAxis(region.x, region.width, tileSize, overlap, xs, tileW);
+    splitAxis(region.y, region.height, tileSize, overlap, ys, tileH);
+    for (int y : ys) {
+        for (int x : xs) tiles.push_back(cv::Rect(x, y, tileW, tileH));
+    }
+    return tiles;
+}
+
+} // namespace CourtTiling
@@ -0,0 +1,245 @@
+#include "DetectionTrace.h"
+#include "AnalysisSession.h"
+#include <algorithm>
+#include <cstring>
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+TraceWriter::~TraceWriter() {
+    close();
+}
+
+bool TraceWriter::open(const std::string& path, cv::Size frameSize, double fps, cv::Point2f outRefPoint,
+                       const CourtModel* court) {
+    close();
+    out.open(path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) return false;
+
+    header = DetectionTrace::Header();
+    std::memcpy(header.magic, DetectionTrace::MAGIC, sizeof(DetectionTrace::MAGIC));
+    header.version = DetectionTrace::VERSION;
+    header.width = frameSize.width;
+    header.height = frameSize.height;
+    header.fps = fps;
+    header.outRef[0] = outRefPoint.x;
+    header.outRef[1] = outRefPoint.y;
+    if (court && court->valid()) {
+        header.hasCourt = 1;
+        for (int i = 0; i < 4; ++i) {
+            header.courtCorners[2 * i] = court->corners()[i].x;
+            header.courtCorners[2 * i + 1] = court->corners()[i].y;
+        }
+    }
+    offsets.clear();
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    position = sizeof(header);
+    return out.good();
+}
+
+void TraceWriter::write(long frameIndex, double timestampMs, const std::vector<Detection>& detections,
+                        const std::vector<ColorStats::RoiStats>& stats, const CourtLine* line) {
+    if (!out.is_open()) return;
+
+    DetectionTrace::Frame frame = {};
+    frame.index = frameIndex;
+    frame.timestampMs = timestampMs;
+    frame.count = (uint32_t)detections.size();
+    if (line) {
+        frame.flags |= DetectionTrace::FRAME_HAS_LINE;
+        frame.line[0] = line->pt1.x;
+        frame.line[1] = line->pt1.y;
+        frame.line[2] = line->pt2.x;
+        frame.line[3] = line->pt2.y;
+    }
+
+    records.resize(detections.size());
+    for (size_t i = 0; i < detections.size(); ++i) {
+        const Detection& det = detections[i];
+        DetectionTrace::Detection& r = records[i];
+        r.classId = det.class_id;
+        r.confidence = det.confidence;
+        r.box[0] = det.box.x;
+        r.box[1] = det.box.y;
+        r.box[2] = det.box.width;
+        r.box[3] = det.box.height;
+        // Frame không qua tracker.update(frame) (stats thiếu) -> coi như bbox không hợp lệ
+        ColorStats::RoiStats s = i < stats.size() ? stats[i] : ColorStats::RoiStats();
+        r.gray = s.gray;
+        r.saturation = s.saturation;
+        r.value = s.value;
+        r.valid = s.valid ? 1u : 0u;
+    }
+
+    offsets.push_back(position);
+    out.write(reinterpret_cast<const char*>(&frame), sizeof(frame));
+    if (!records.empty()) {
+        out.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(DetectionTrace::Detection));
+    }
+    position += sizeof(frame) + records.size() * sizeof(DetectionTrace::Detection);
+}
+
+void TraceWriter::close() {
+    if (!out.is_open()) return;
+    header.frameCount = offsets.size();
+    header.indexOffset = position;
+    if (!offsets.empty()) {
+        out.write(reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(uint64_t));
+    }
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.close();
+}
+
+TraceReader::~TraceReader() {
+    close();
+}
+
+void TraceReader::close() {
+#if !defined(_WIN32)
+    if (data && fallback.empty()) munmap(const_cast<char*>(data), size);
+#endif
+    data = nullptr;
+    size = 0;
+    fallback.clear();
+    frameOffsets.clear();
+}
+
+bool TraceReader::open(const std::string& path) {
+    close();
+#if !defined(_WIN32)
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(DetectionTrace::Header)) {
+        void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            // Replay đọc tuần tự từ đầu tới cuối
+            madvise(p, (size_t)st.st_size, MADV_SEQUENTIAL);
+            data = static_cast<const char*>(p);
+            size = (size_t)st.st_size;
+        }
+    }
+    ::close(fd);
+#else
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (in.is_open() && (size_t)in.tellg() >= sizeof(DetectionTrace::Header)) {
+        fallback.resize((size_t)in.tellg());
+        in.seekg(0);
+        if (in.read(fallback.data(), fallback.size())) {
+            data = fallback.data();
+            size = fallback.size();
+        }
+    }
+#endif
+    if (!data) return false;
+    if (!buildIndex()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool TraceReader::buildIndex() {
+    const DetectionTrace::Header& h = header();
+    if (std::memcmp(h.magic, DetectionTrace::MAGIC, sizeof(DetectionTrace::MAGIC)) != 0 ||
+        h.version != DetectionTrace::VERSION) {
+        return false;
+    }
+
+    // Record cỡ cố định là bội của 8 byte -> mọi Frame / Detection đọc thẳng từ vùng map đều căn lề
+    if (h.frameCount > 0 && h.indexOffset <= size &&
+        h.frameCount <= (size - h.indexOffset) / sizeof(uint64_t)) {
+        frameOffsets.resize(h.frameCount);
+        std::memcpy(frameOffsets.data(), data + h.indexOffset, h.frameCount * sizeof(uint64_t));
+    } else {
+        // Không có bảng index (writer không kịp close) hoặc file bị cắt mất bảng index (copy dở):
+        // quét tuần tự tới record cuối còn nguyên vẹn, không bao giờ vượt quá vùng đã map
+        uint64_t end = h.frameCount > 0 ? std::min<uint64_t>(h.indexOffset, size) : (uint64_t)size;
+        uint64_t pos = sizeof(DetectionTrace::Header);
+        while (pos + sizeof(DetectionTrace::Frame) <= end) {
+            const DetectionTrace::Frame* f = reinterpret_cast<const DetectionTrace::Frame*>(data + pos);
+            uint64_t next = pos + sizeof(DetectionTrace::Frame) + (uint64_t)f->count * sizeof(DetectionTrace::Detection);
+            if (next > end) break;
+            frameOffsets.push_back(pos);
+            pos = next;
+        }
+    }
+
+    for (uint64_t offset : frameOffsets) {
+        if (offset < sizeof(DetectionTrace::Header) || offset + sizeof(DetectionTrace::Frame) > size) return false;
+        const DetectionTrace::Frame* f = reinterpret_cast<const DetectionTrace::Frame*>(data + offset);
+        if (f->count > (size - offset - sizeof(DetectionTrace::Frame)) / sizeof(DetectionTrace::Detection)) return false;
+    }
+    return true;
+}
+
+TraceReader::FrameView TraceReader::frame(size_t i) const {
+    FrameView view;
+    const char* p = data + frameOffsets[i];
+    view.frame = reinterpret_cast<const DetectionTrace::Frame*>(p);
+    view.detections = reinterpret_cast<const DetectionTrace::Detection*>(p + sizeof(DetectionTrace::Frame));
+    return view;
+}
+
+namespace DetectionTrace {
+
+long replay(const TraceReader& trace, const FrameFn& onFrame) {
+    // Cùng bước track -> IN/OUT như lúc ghi (AnalysisSession::track), sân dựng lại từ 4 góc trong header
+    const Header& h = trace.header();
+    SessionOptions options;
+    options.autoCourtLine = false;
+    options.hasOutRefPoint = true;
+    options.outRefPoint = cv::Point2f(h.outRef[0], h.outRef[1]);
+    options.courtModel = h.hasCourt != 0;
+    if (h.hasCourt) {
+        for (int i = 0; i < 4; ++i) options.courtCorners.emplace_back(h.courtCorners[2 * i], h.courtCorners[2 * i + 1]);
+    }
+    options.lineTracking = false;
+    options.tiled = false;
+    AnalysisSession session(options);
+    session.begin(cv::Size(h.width, h.height));
+
+    std::vector<cv::Rect> boxes;
+    std::vector<ColorStats::RoiStats> stats;
+    TrackResult result;
+    CourtLine line;
+    for (size_t i = 0; i < trace.frames(); ++i) {
+        TraceReader::FrameView view = trace.frame(i);
+        boxes.clear();
+        stats.clear();
+        for (uint32_t d = 0; d < view.frame->count; ++d) {
+            const Detection& r = view.detections[d];
+            boxes.emplace_back(r.box[0], r.box[1], r.box[2], r.box[3]);
+            ColorStats::RoiStats s;
+            s.gray = r.gray;
+            s.saturation = r.saturation;
+            s.value = r.value;
+            s.valid = r.valid != 0;
+            stats.push_back(s);
+        }
+
+        bool hasLine = (view.frame->flags & FRAME_HAS_LINE) != 0;
+        if (hasLine) {
+            const float* l = view.frame->line;
+            line.pt1 = cv::Point2f(l[0], l[1]);
+            line.pt2 = cv::Point2f(l[2], l[3]);
+            line.length = (float)cv::norm(line.pt2 - line.pt1);
+        }
+        session.track(boxes, stats, hasLine ? &line : nullptr, result);
+        if (onFrame) onFrame((long)view.frame->index, view.frame->timestampMs, result);
+    }
+    return (long)trace.frames();
+}
+
+std::string eventsPathFor(const std::string& tracePath) {
+    size_t slash = tracePath.find_last_of("/\\");
+    size_t dot = tracePath.find_last_of('.');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) return tracePath + ".events.jsonl";
+    return tracePath.substr(0, dot) + ".events.jsonl";
+}
+
+}
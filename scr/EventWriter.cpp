@@ -0,0 +1,53 @@
+#include "EventWriter.h"
+#include "CourtModel.h"
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+
+EventWriter::EventWriter(const std::string& path) : out(path) {}
+
+// Nối 1 trường vào line (mỗi trường ngắn, buffer tạm cắt an toàn nếu vượt)
+static void appendf(std::string& line, const char* fmt, ...) {
+    char field[256];
+    va_list args;
+    va_start(args, fmt);
+    int n = std::vsnprintf(field, sizeof(field), fmt, args);
+    va_end(args);
+    if (n > 0) line.append(field, std::min((size_t)n, sizeof(field) - 1));
+}
+
+void EventWriter::write(long frameIndex, double timestampMs, const TrackResult& result) {
+    if (!out.is_open() || (!result.hasBall && !result.bounceDetected)) return;
+
+    // line giữ capacity giữa các lần gọi -> không cấp phát ở trạng thái ổn định
+    line.clear();
+    appendf(line, "{\"frame\":%ld,\"t_ms\":%.1f", frameIndex, timestampMs);
+    if (result.hasBall) {
+        appendf(line, ",\"track\":%d,\"ball\":[%.1f,%.1f]", result.trackId, result.ballPos.x, result.ballPos.y);
+    }
+    if (result.bounceDetected) {
+        if (result.hasBouncePoint) {
+            appendf(line, ",\"bounce\":{\"x\":%.1f,\"y\":%.1f,\"verdict\":\"%s\"",
+                    result.bouncePoint.x, result.bouncePoint.y, result.verdict.c_str());
+            if (result.bounceFrameOffset < 0.0f) {
+                appendf(line, ",\"frame_exact\":%.2f", frameIndex + result.bounceFrameOffset);
+            }
+            if (result.zone >= 0) {
+                appendf(line, ",\"zone\":\"%s\"", CourtModel::zoneName(result.zone));
+            }
+            if (result.hasCourtPos) {
+                appendf(line, ",\"court_m\":[%.3f,%.3f]", result.courtPos.x, result.courtPos.y);
+            }
+            if (result.latencyMs >= 0.0f) {
+                appendf(line, ",\"latency_ms\":%.1f", result.latencyMs);
+            }
+            line += '}';
+        } else {
+            // Phát hiện bounce nhưng chưa đủ lịch sử để tính điểm chạm
+            line += ",\"bounce\":{}";
+        }
+    }
+    line += "}\n";
+    out.write(line.data(), line.size());
+    ++lines;
+}
@@ -3,34 +3,33 @@
 
 KalmanWrapper::KalmanWrapper() {
     // 4 trạng thái (x, y, dx, dy), 2 đo lường (x, y)
-    kf = cv::KalmanFilter(4, 2, 0); 
-    
     // Transition Matrix
-    kf.transitionMatrix = (cv::Mat_<float>(4, 4) << 
+    transition = cv::Matx44f(
         1, 0, 1, 0,
         0, 1, 0, 1,
         0, 0, 1, 0,
         0, 0, 0, 1);
-        
+
     // Measurement Matrix
-    kf.measurementMatrix = (cv::Mat_<float>(2, 4) <<
+    measurement = cv::Matx<float, 2, 4>(
         1, 0, 0, 0,
         0, 1, 0, 0);
 
     // Noise
-    cv::setIdentity(kf.processNoiseCov, cv::Scalar::all(Config::PROCESS_NOISE));
-    cv::setIdentity(kf.measurementNoiseCov, cv::Scalar::all(Config::MEASUREMENT_NOISE));
-    cv::setIdentity(kf.errorCovPost, cv::Scalar::all(1));
+    processNoise = cv::Matx44f::eye() * Config::PROCESS_NOISE;
+    measurementNoise = cv::Matx22f::eye() * Config::MEASUREMENT_NOISE;
+    errorCov = cv::Matx44f::eye();
 }
 
 void KalmanWrapper::init(float px, float py) {
-    kf.statePost = (cv::Mat_<float>(4, 1) << px, py, 0, 0);
+    state = cv::Matx41f(px, py, 0, 0);
     initialized = true;
 }
 
 cv::Point2f KalmanWrapper::predict() {
-    cv::Mat p = kf.predict();
-    return cv::Point2f(p.at<float>(0), p.at<float>(1));
+    state = transition * state;
+    errorCov = transition * errorCov * transition.t() + processNoise;
+    return cv::Point2f(state(0), state(1));
 }
 
 cv::Point2f KalmanWrapper::update(float x, float y) {
@@ -38,13 +37,21 @@ cv::Point2f KalmanWrapper::update(float x, float y) {
         init(x, y);
         return predict();
     }
-    
-    cv::Mat measurement = (cv::Mat_<float>(2, 1) << x, y);
-    kf.correct(measurement);
-    cv::Mat p = kf.predict();
-    return cv::Point2f(p.at<float>(0), p.at<float>(1));
+
+    // Correct
+    cv::Matx21f z(x, y);
+    cv::Matx22f s = measurement * errorCov * measurement.t() + measurementNoise;
+    cv::Matx<float, 4, 2> gain = errorCov * measurement.t() * s.inv();
+    state += gain * (z - measurement * state);
+    errorCov = (cv::Matx44f::eye() - gain * measurement) * errorCov;
+    return predict();
+}
+
+cv::Point2f KalmanWrapper::velocity() const {
+    return cv::Point2f(state(2), state(3));
 }
 
 void KalmanWrapper::reset() {
     initialized = false;
-}
\ No newline at end of file
+    errorCov = cv::Matx44f::eye();
+}
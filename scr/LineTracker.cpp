@@ -0,0 +1,155 @@
+#include "LineTracker.h"
+#include "Config.h"
+#include <algorithm>
+#include <cmath>
+
+// Cùng ngưỡng trắng với LineDetector::detect (HSV: S <= 80, V >= 130) nhưng tính trực tiếp trên BGR
+static inline bool isWhite(const cv::Vec3b& p) {
+    int mx = std::max(p[0], std::max(p[1], p[2]));
+    int mn = std::min(p[0], std::min(p[1], p[2]));
+    return mx >= 130 && (mx - mn) * 255 <= 80 * mx;
+}
+
+LineTracker::LineTracker() {}
+
+void LineTracker::init(const CourtLine& line) {
+    current = line;
+    initialized = true;
+    lastIndex = -1;
+    avgResidual = -1.0f;
+    failStreak = 0;
+    nextRedetectIndex = -1;
+    lastRedetected = false;
+}
+
+bool LineTracker::refit(const cv::Mat& frame, CourtLine& fitted, float& residual, float& support) {
+    cv::Point2f d = current.pt2 - current.pt1;
+    float len = std::sqrt(d.x * d.x + d.y * d.y);
+    if (len < 1.0f || frame.type() != CV_8UC3) return false;
+    cv::Point2f dir = d * (1.0f / len);
+    cv::Point2f normal(-dir.y, dir.x);
+
+    const int n = Config::LINE_TRACK_SAMPLES;
+    const int band = Config::LINE_TRACK_BAND;
+    const int step = Config::LINE_TRACK_STEP;
+    samples.clear();
+    for (int i = 0; i < n; ++i) {
+        cv::Point2f c = current.pt1 + dir * (len * (i + 0.5f) / n);
+
+        // Quét đoạn vuông góc, lấy tâm của vệt trắng gần line cũ nhất
+        float bestCenter = 0.0f, bestDist = 1e9f;
+        int runStart = 0;
+        bool inRun = false;
+        for (int o = -band; o <= band + step; o += step) {
+            bool white = false;
+            if (o <= band) {
+                int x = (int)std::lround(c.x + normal.x * o);
+                int y = (int)std::lround(c.y + normal.y * o);
+                white = x >= 0 && y >= 0 && x < frame.cols && y < frame.rows && isWhite(frame.at<cv::Vec3b>(y, x));
+            }
+            if (white && !inRun) {
+                inRun = true;
+                runStart = o;
+            } else if (!white && inRun) {
+                inRun = false;
+                float center = (runStart + o - step) * 0.5f;
+                if (std::fabs(center) < bestDist) {
+                    bestDist = std::fabs(center);
+                    bestCenter = center;
+                }
+            }
+        }
+        if (bestDist < 1e9f) samples.push_back(c + normal * bestCenter);
+    }
+
+    support = (float)samples.size() / n;
+    if (samples.size() < 2) return false;
+
+    cv::Vec4f params;
+    cv::fitLine(samples, params, cv::DIST_HUBER, 0, 0.01, 0.01);
+    cv::Point2f v(params[0], params[1]);
+    cv::Point2f p0(params[2], params[3]);
+    cv::Point2f nrm(-v.y, v.x);
+
+    double sq = 0.0;
+    for (const auto& p : samples) {
+        float dist = (p - p0).dot(nrm);
+        sq += dist * dist;
+    }
+    residual = (float)std::sqrt(sq / samples.size());
+
+    // Giữ độ dài đoạn: chiếu 2 đầu mút cũ lên line mới
+    fitted.pt1 = p0 + v * (current.pt1 - p0).dot(v);
+    fitted.pt2 = p0 + v * (current.pt2 - p0).dot(v);
+    fitted.length = (float)cv::norm(fitted.pt2 - fitted.pt1);
+    return true;
+}
+
+bool LineTracker::redetect(const cv::Mat& frame, CourtLine& found) {
+    frameLines = detector.detect(frame);
+
+    cv::Point2f d = current.pt2 - current.pt1;
+    float len = std::max(1.0f, (float)cv::norm(d));
+    cv::Point2f dir = d * (1.0f / len);
+    cv::Point2f mid = (current.pt1 + current.pt2) * 0.5f;
+
+    // Chi phí = khoảng cách trung điểm tới trung điểm cũ + phạt lệch hướng
+    float bestCost = 1e9f;
+    for (const auto& l : frameLines) {
+        cv::Point2f ld = l.pt2 - l.pt1;
+        float llen = std::max(1.0f, l.length);
+        float cosAngle = std::fabs(ld.dot(dir)) / llen;
+        if (cosAngle < std::cos(Config::LINE_REDETECT_MAX_ANGLE_DEG * (float)CV_PI / 180.0f)) continue;
+        float cost = (float)cv::norm((l.pt1 + l.pt2) * 0.5f - mid);
+        if (cost < bestCost) {
+            bestCost = cost;
+            found = l;
+        }
+    }
+    if (bestCost > Config::LINE_REDETECT_MAX_DIST) return false;
+
+    // Giữ chiều pt1 -> pt2 như line cũ (outRefPoint / sideValue phụ thuộc chiều)
+    if ((found.pt2 - found.pt1).dot(dir) < 0) std::swap(found.pt1, found.pt2);
+    return true;
+}
+
+bool LineTracker::update(const cv::Mat& frame, long frameIndex) {
+    lastRedetected = false;
+    if (!initialized) return false;
+    if (lastIndex >= 0 && frameIndex - lastIndex < Config::LINE_TRACK_INTERVAL) return false;
+    lastIndex = frameIndex;
+
+    CourtLine fitted;
+    float residual = 0.0f, support = 0.0f;
+    bool ok = refit(frame, fitted, residual, support);
+    float limit = std::max(Config::LINE_TRACK_MIN_RESIDUAL,
+                           avgResidual < 0.0f ? 0.0f : Config::LINE_TRACK_RESIDUAL_JUMP * avgResidual);
+
+    if (ok && support >= Config::LINE_TRACK_MIN_SUPPORT && residual <= limit) {
+        ++refitCount;
+        avgResidual = avgResidual < 0.0f ? residual : 0.9f * avgResidual + 0.1f * residual;
+        current = fitted;
+        failStreak = 0;
+        nextRedetectIndex = -1;
+        return true;
+    }
+
+    // Residual tăng vọt / mất vệt trắng: có thể chỉ bị người đứng che -> thử detect lại cả frame,
+    // không tìm thấy line nào gần thì giữ line cũ và giãn lần thử kế tiếp
+    if (frameIndex < nextRedetectIndex) return false;
+    CourtLine found;
+    if (!redetect(frame, found)) {
+        ++redetectFailCount;
+        ++failStreak;
+        long wait = (long)Config::LINE_TRACK_INTERVAL << std::min(failStreak, 16);
+        nextRedetectIndex = frameIndex + std::min(wait, (long)Config::LINE_REDETECT_MAX_BACKOFF);
+        return false;
+    }
+    ++redetectCount;
+    failStreak = 0;
+    nextRedetectIndex = -1;
+    lastRedetected = true;
+    current = found;
+    avgResidual = -1.0f;
+    return true;
+}
@@ -0,0 +1,81 @@
+#include "LinearAssignment.h"
+#include <algorithm>
+#include <limits>
+
+void LinearAssignment::solveTall(const float* cost, int n, int m) {
+    const double INF = std::numeric_limits<double>::max();
+    u.assign(n + 1, 0.0);
+    v.assign(m + 1, 0.0);
+    p.assign(m + 1, 0);
+    way.assign(m + 1, 0);
+    minv.resize(m + 1);
+    used.resize(m + 1);
+
+    // Thêm lần lượt từng hàng, tìm đường tăng ngắn nhất theo chi phí rút gọn
+    for (int i = 1; i <= n; ++i) {
+        p[0] = i;
+        int j0 = 0;
+        std::fill(minv.begin(), minv.end(), INF);
+        std::fill(used.begin(), used.end(), 0);
+        do {
+            used[j0] = 1;
+            int i0 = p[j0];
+            int j1 = 0;
+            double delta = INF;
+            const float* row = cost + (size_t)(i0 - 1) * m;
+            for (int j = 1; j <= m; ++j) {
+                if (used[j]) continue;
+                double cur = row[j - 1] - u[i0] - v[j];
+                if (cur < minv[j]) {
+                    minv[j] = cur;
+                    way[j] = j0;
+                }
+                if (minv[j] < delta) {
+                    delta = minv[j];
+                    j1 = j;
+                }
+            }
+            for (int j = 0; j <= m; ++j) {
+                if (used[j]) {
+                    u[p[j]] += delta;
+                    v[j] -= delta;
+                } else {
+                    minv[j] -= delta;
+                }
+            }
+            j0 = j1;
+        } while (p[j0] != 0);
+
+        // Đảo đường tăng
+        do {
+            int j1 = way[j0];
+            p[j0] = p[j1];
+            j0 = j1;
+        } while (j0);
+    }
+}
+
+void LinearAssignment::solve(const float* cost, int rows, int cols, std::vector<int>& rowToCol) {
+    rowToCol.assign(rows, -1);
+    if (rows == 0 || cols == 0) return;
+
+    if (rows <= cols) {
+        solveTall(cost, rows, cols);
+        for (int j = 1; j <= cols; ++j) {
+            if (p[j] != 0) rowToCol[p[j] - 1] = j - 1;
+        }
+        return;
+    }
+
+    // Nhiều hàng hơn cột -> giải trên ma trận chuyển vị
+    transposed.resize((size_t)rows * cols);
+    for (int i = 0; i < rows; ++i) {
+        for (int j = 0; j < cols; ++j) {
+            transposed[(size_t)j * rows + i] = cost[(size_t)i * cols + j];
+        }
+    }
+    solveTall(transposed.data(), cols, rows);
+    for (int i = 1; i <= rows; ++i) {
+        if (p[i] != 0) rowToCol[i - 1] = p[i] - 1;
+    }
+}
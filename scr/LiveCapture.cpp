@@ -0,0 +1,80 @@
+#include "LiveCapture.h"
+#include <algorithm>
+#include <cctype>
+#include <utility>
+
+LiveCapture::~LiveCapture() {
+    stop();
+}
+
+bool LiveCapture::open(const std::string& source) {
+    bool isCamera = !source.empty() && std::all_of(source.begin(), source.end(),
+                                                      [](unsigned char c) { return std::isdigit(c) != 0; });
+    bool isStream = source.find("://") != std::string::npos;
+    if (isCamera) cap.open(std::stoi(source));
+    else cap.open(source);
+    if (!cap.isOpened()) return false;
+
+    // Giảm buffer của driver xuống 1 frame (backend không hỗ trợ thì bỏ qua)
+    cap.set(cv::CAP_PROP_BUFFERSIZE, 1);
+    size = cv::Size((int)cap.get(cv::CAP_PROP_FRAME_WIDTH), (int)cap.get(cv::CAP_PROP_FRAME_HEIGHT));
+    sourceFps = cap.get(cv::CAP_PROP_FPS);
+    paced = !isCamera && !isStream && sourceFps > 0.0;
+    return true;
+}
+
+void LiveCapture::start() {
+    if (running.exchange(true)) return;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        ended = false;
+        fresh = false;
+    }
+    thread = std::thread(&LiveCapture::captureLoop, this);
+}
+
+void LiveCapture::stop() {
+    running.store(false);
+    if (thread.joinable()) thread.join();
+    std::lock_guard<std::mutex> lock(mtx);
+    ended = true;
+    frameCv.notify_all();
+}
+
+void LiveCapture::captureLoop() {
+    Clock::time_point next = Clock::now();
+    const auto period = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(paced ? 1.0 / sourceFps : 0.0));
+    long sequence = 0;
+    while (running.load(std::memory_order_relaxed)) {
+        if (paced) {
+            std::this_thread::sleep_until(next);
+            next += period;
+        }
+        if (!cap.read(reading)) break;
+        Clock::time_point now = Clock::now();
+        capturedCount.fetch_add(1, std::memory_order_relaxed);
+
+        std::lock_guard<std::mutex> lock(mtx);
+        if (fresh) droppedCount.fetch_add(1, std::memory_order_relaxed); // Frame trước chưa ai lấy -> bỏ
+        std::swap(reading, slot);
+        slotTime = now;
+        slotSequence = sequence++;
+        fresh = true;
+        frameCv.notify_one();
+    }
+    std::lock_guard<std::mutex> lock(mtx);
+    ended = true;
+    frameCv.notify_all();
+}
+
+bool LiveCapture::latest(cv::Mat& frame, Clock::time_point& capturedAt, long& sequence) {
+    std::unique_lock<std::mutex> lock(mtx);
+    frameCv.wait(lock, [this]() { return fresh || ended; });
+    if (!fresh) return false;
+    std::swap(frame, slot);
+    capturedAt = slotTime;
+    sequence = slotSequence;
+    fresh = false;
+    return true;
+}
@@ -0,0 +1,129 @@
+#include "LiveRunner.h"
+#include "Renderer.h"
+#include "StageMetrics.h"
+#include "Config.h"
+#include <algorithm>
+#include <iostream>
+
+LiveRunner::LiveRunner(const std::string& modelPath, double deadlineMs, const SessionOptions& options)
+    : detector(modelPath), deadlineMs(deadlineMs), options(options) {
+    // Forward thử 1 lần: lần inference nguội đầu tiên không được tính là trễ deadline
+    cv::Mat warmFrame(640, 640, CV_8UC3, cv::Scalar(0, 0, 0));
+    std::vector<Detection> detections;
+    detector.detect(warmFrame, detections);
+    // Thử input nhỏ: model export input cố định thì các mức giảm input không giảm được chi phí nào
+    detector.detectRoi(warmFrame, cv::Rect(0, 0, warmFrame.cols, warmFrame.rows), Config::LIVE_REDUCED_INPUT_SIZE,
+                       detections);
+    dynamicInput = detector.dynamicInput();
+    if (!dynamicInput) std::cout << "[live] fixed-size model input, skipping the reduced-input levels" << std::endl;
+}
+
+const char* LiveRunner::levelName(int level) {
+    static const char* names[LEVEL_COUNT] = {"full", "no-overlay", "reduced-input", "min-input", "half-rate"};
+    return (level >= 0 && level < LEVEL_COUNT) ? names[level] : "unknown";
+}
+
+double LiveRunner::bounceLatencyPercentile(double q) const {
+    if (bounceLatencyMs.empty()) return 0.0;
+    std::vector<float> sorted(bounceLatencyMs);
+    size_t index = std::min(sorted.size() - 1, (size_t)(q * (sorted.size() - 1) + 0.5));
+    std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+    return sorted[index];
+}
+
+int LiveRunner::inputSizeFor(int level) const {
+    if (!dynamicInput) return 640;
+    if (level >= LEVEL_MIN_INPUT) return Config::LIVE_MIN_INPUT_SIZE;
+    if (level >= LEVEL_REDUCED_INPUT) return Config::LIVE_REDUCED_INPUT_SIZE;
+    return 640;
+}
+
+int LiveRunner::stepLevel(int level, int step) const {
+    level += step;
+    while (!dynamicInput && (level == LEVEL_REDUCED_INPUT || level == LEVEL_MIN_INPUT)) level += step;
+    return level;
+}
+
+void LiveRunner::adapt(double latencyMs) {
+    if (latencyMs > deadlineMs) {
+        ++misses;
+        calmFrames = 0;
+        if (++consecutiveMisses >= Config::LIVE_DEGRADE_AFTER && currentLevel < LEVEL_COUNT - 1) {
+            currentLevel = stepLevel(currentLevel, 1);
+            ++degradeCount;
+            consecutiveMisses = 0;
+            std::cout << "[live] deadline missed, degrading to " << levelName(currentLevel) << std::endl;
+        }
+        return;
+    }
+    consecutiveMisses = 0;
+    if (latencyMs > deadlineMs * Config::LIVE_RECOVER_RATIO) {
+        calmFrames = 0;
+        return;
+    }
+    if (++calmFrames >= Config::LIVE_RECOVER_AFTER && currentLevel > LEVEL_FULL) {
+        currentLevel = stepLevel(currentLevel, -1);
+        calmFrames = 0;
+        std::cout << "[live] latency recovered, back to " << levelName(currentLevel) << std::endl;
+    }
+}
+
+long LiveRunner::run(LiveCapture& capture, EventWriter& events, cv::VideoWriter* writer) {
+    AnalysisSession session(options);
+    TrackResult result;
+    std::vector<Detection> detections;
+    cv::Mat frame;
+    LiveCapture::Clock::time_point capturedAt, start;
+    long sequence = 0;
+    bool first = true;
+
+    while (!stopRequested.load() && capture.latest(frame, capturedAt, sequence)) {
+        if (first) {
+            start = capturedAt;
+            first = false;
+            session.begin(frame);
+            if (options.courtModel && !session.court().valid()) {
+                std::cerr << "Court calibration failed, falling back to the selected line" << std::endl;
+            }
+        }
+
+        // Half rate: frame lẻ không chạy YOLO, tracker chỉ predict (Kalman) trên frame đó
+        int inputSize = inputSizeFor(currentLevel);
+        if (currentLevel >= LEVEL_HALF_RATE && (processed & 1)) detections.clear();
+        else if (inputSize == 640) detector.detect(frame, detections);
+        else detector.detectRoi(frame, cv::Rect(0, 0, frame.cols, frame.rows), inputSize, detections);
+
+        session.track(frame, sequence, detections, result);
+
+        // Quyết định IN/OUT của frame đã có: đo từ lúc camera trả frame
+        auto decided = LiveCapture::Clock::now();
+        double latencyMs = std::chrono::duration<double, std::milli>(decided - capturedAt).count();
+        result.latencyMs = (float)latencyMs;
+        METRICS_RECORD(LATENCY, std::chrono::duration_cast<std::chrono::nanoseconds>(decided - capturedAt).count());
+        ++processed;
+        latencySumMs += latencyMs;
+        if (latencyMs > latencyMaxMs) latencyMaxMs = latencyMs;
+        if (result.bounceDetected) bounceLatencyMs.push_back((float)latencyMs);
+
+        {
+            METRICS_SCOPE(EVENTS);
+            double timestampMs = std::chrono::duration<double, std::milli>(capturedAt - start).count();
+            events.write(sequence, timestampMs, result);
+        }
+        if (writer && writer->isOpened() && currentLevel == LEVEL_FULL) {
+            {
+                METRICS_SCOPE(RENDER);
+                Renderer::drawTrack(frame, result);
+                if (session.hasCourtLine()) Renderer::drawCourtLine(frame, session.courtLine(), session.outRef());
+            }
+            METRICS_SCOPE(WRITE);
+            writer->write(frame);
+        }
+
+        // Thời gian overlay / encode làm frame kế tiếp già đi -> cũng nằm trong latency của frame sau
+        adapt(latencyMs);
+        METRICS_FRAME_DONE();
+        METRICS_REPORT_PERIODIC(std::cout, Config::METRICS_INTERVAL_S);
+    }
+    return processed;
+}
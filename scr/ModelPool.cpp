@@ -0,0 +1,57 @@
+#include "ModelPool.h"
+#include <algorithm>
+
+ModelPool::ModelPool(const std::string& modelPath, int size, Precision precision, const std::string& calibrationDir) {
+    // Frame đen 640x640 đủ để dnn cấp phát blob của mọi layer và chọn kernel trước frame thật đầu tiên
+    cv::Mat warmFrame(640, 640, CV_8UC3, cv::Scalar(0, 0, 0));
+    std::vector<Detection> detections;
+    for (int i = 0; i < std::max(1, size); ++i) {
+        detectors.emplace_back(new YoloDetector(modelPath, precision, calibrationDir));
+        detectors.back()->detect(warmFrame, detections);
+        idle.push_back(detectors.back().get());
+    }
+}
+
+ModelPool::Lease& ModelPool::Lease::operator=(Lease&& other) noexcept {
+    if (this != &other) {
+        reset();
+        pool = other.pool;
+        detector = other.detector;
+        other.detector = nullptr;
+    }
+    return *this;
+}
+
+void ModelPool::Lease::reset() {
+    if (detector) pool->release(detector);
+    detector = nullptr;
+}
+
+ModelPool::Lease ModelPool::acquire() {
+    std::unique_lock<std::mutex> lock(mtx);
+    idleCv.wait(lock, [&]() { return !idle.empty(); });
+    YoloDetector* detector = idle.back();
+    idle.pop_back();
+    return Lease(this, detector);
+}
+
+ModelPool::Lease ModelPool::tryAcquire() {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (idle.empty()) return Lease();
+    YoloDetector* detector = idle.back();
+    idle.pop_back();
+    return Lease(this, detector);
+}
+
+int ModelPool::available() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return (int)idle.size();
+}
+
+void ModelPool::release(YoloDetector* detector) {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        idle.push_back(detector);
+    }
+    idleCv.notify_one();
+}
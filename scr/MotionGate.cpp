@@ -0,0 +1,74 @@
+#include "MotionGate.h"
+#include "Config.h"
+#include "StageMetrics.h"
+#include <algorithm>
+#include <cmath>
+
+MotionGate::MotionGate() {}
+
+cv::Rect MotionGate::toFrameRegion(const cv::Rect& motion, cv::Size smallSize, cv::Size frameSize) {
+    float sx = (float)frameSize.width / smallSize.width;
+    float sy = (float)frameSize.height / smallSize.height;
+    float cx = (motion.x + motion.width / 2.0f) * sx;
+    float cy = (motion.y + motion.height / 2.0f) * sy;
+    float side = std::max(motion.width * sx, motion.height * sy) + 2.0f * Config::MOTION_REGION_PADDING;
+
+    // Vùng chuyển động quá lớn -> crop không tiết kiệm được gì, detect cả frame
+    float frameArea = (float)frameSize.width * frameSize.height;
+    int maxSide = std::min(frameSize.width, frameSize.height);
+    if (side * side > Config::MOTION_MAX_REGION_FRACTION * frameArea || side >= maxSide) return cv::Rect();
+
+    // Vuông để resize không méo, dịch vào trong frame thay vì cắt (như RoiScheduler::searchWindow)
+    int s = (int)side;
+    int x = std::max(0, std::min((int)(cx - s / 2.0f), frameSize.width - s));
+    int y = std::max(0, std::min((int)(cy - s / 2.0f), frameSize.height - s));
+    return cv::Rect(x, y, s, s);
+}
+
+bool MotionGate::evaluate(const cv::Mat& frame, cv::Rect& region, int& inputSize) {
+    METRICS_SCOPE(GATE);
+    region = cv::Rect();
+    inputSize = 640;
+
+    int width = Config::MOTION_DOWNSCALE_WIDTH;
+    int height = std::max(1, frame.rows * width / std::max(1, frame.cols));
+    cv::resize(frame, resized, cv::Size(width, height), 0, 0, cv::INTER_AREA);
+    if (resized.channels() == 3) {
+        cv::cvtColor(resized, small, cv::COLOR_BGR2GRAY);
+    } else {
+        resized.copyTo(small);
+    }
+    cv::GaussianBlur(small, small, cv::Size(5, 5), 0);
+
+    if (prev.empty() || prev.size() != small.size()) {
+        // Frame đầu: chưa có gì để so -> detect cả frame
+        std::swap(prev, small);
+        hold = Config::MOTION_HOLD_FRAMES;
+        return true;
+    }
+
+    cv::absdiff(small, prev, diff);
+    cv::threshold(diff, diff, Config::MOTION_PIXEL_THRESHOLD, 255, cv::THRESH_BINARY);
+    std::swap(prev, small);
+
+    if (cv::countNonZero(diff) >= Config::MOTION_MIN_PIXELS) {
+        hold = Config::MOTION_HOLD_FRAMES;
+        lastRegion = toFrameRegion(cv::boundingRect(diff), diff.size(), frame.size());
+    } else if (hold > 0) {
+        // Vừa hết chuyển động (bóng dừng, rơi ra khỏi khung): detect thêm vài frame ở vùng cũ
+        --hold;
+    } else {
+        ++skipCount;
+        return false;
+    }
+
+    region = lastRegion;
+    if (region.area() > 0) {
+        // Giữ nguyên tỉ lệ pixel / input như khi detect cả frame ở 640, làm tròn lên bội 32
+        float scale = 640.0f / std::max(frame.cols, frame.rows);
+        int size = ((int)std::ceil(region.width * scale / 32.0f)) * 32;
+        inputSize = std::max(Config::ROI_INPUT_SIZE, std::min(640, size));
+        ++regionCount;
+    }
+    return true;
+}
@@ -0,0 +1,219 @@
+#include "Pipeline.h"
+#include "BoundedQueue.h"
+#include "StageMetrics.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <algorithm>
+
+Pipeline::Pipeline(const std::string& modelPath, int detectWorkers, size_t queueCapacity,
+                   int batchSize, int batchTimeoutMs)
+    : queueCapacity(queueCapacity), batchSize(std::max(1, batchSize)), batchTimeoutMs(std::max(0, batchTimeoutMs)) {
+    int workers = std::max(1, detectWorkers);
+    for (int i = 0; i < workers; ++i) {
+        detectors.push_back(std::make_unique<YoloDetector>(modelPath));
+    }
+
+    // Chia core cho các worker để net.forward của các luồng không tranh nhau toàn bộ CPU
+    if (workers > 1) {
+        int cores = (int)std::thread::hardware_concurrency();
+        cv::setNumThreads(std::max(1, cores / workers));
+    }
+}
+
+Pipeline::Pipeline(size_t queueCapacity)
+    : queueCapacity(queueCapacity), batchSize(1), batchTimeoutMs(0) {}
+
+long Pipeline::run(cv::VideoCapture& cap, const StageFn& trackFn, const StageFn& sinkFn) {
+    if (detectors.empty()) return 0; // Không có worker nào đóng detectQueue
+    BoundedQueue<FramePacket> decodeQueue(queueCapacity);
+    BoundedQueue<FramePacket> detectQueue(queueCapacity);
+    BoundedQueue<FramePacket> sinkQueue(queueCapacity);
+
+    // Giới hạn số frame đang "bay" giữa decode và track,
+    // tránh buffer sắp xếp lại phình to khi 1 worker chậm
+    const long maxInFlight = (long)(2 * queueCapacity + detectors.size() * batchSize);
+    std::mutex flightMtx;
+    std::condition_variable flightCv;
+    long trackedCount = 0;
+
+    // Packet đã encode xong quay lại decode; đủ chỗ cho mọi packet có thể tồn tại cùng lúc
+    BoundedQueue<FramePacket> freePackets(maxInFlight + queueCapacity + 2);
+
+    // Stage 1: Decode
+    std::thread decodeThread([&]() {
+        long index = 0;
+        FramePacket packet;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(flightMtx);
+                flightCv.wait(lock, [&]() { return index - trackedCount < maxInFlight; });
+            }
+            freePackets.tryPop(packet); // Không có packet rảnh thì dùng lại packet vừa move đi (rỗng)
+            packet.recycle();
+            {
+                METRICS_SCOPE(DECODE);
+                if (!cap.read(packet.frame)) break;
+            }
+            packet.index = index++;
+            packet.timestampMs = cap.get(cv::CAP_PROP_POS_MSEC);
+            if (preDetectFn) preDetectFn(packet);
+            if (!decodeQueue.push(std::move(packet))) break;
+        }
+        decodeQueue.close();
+    });
+
+    // Stage 2: Detect (N worker)
+    std::atomic<int> activeWorkers((int)detectors.size());
+    std::vector<std::thread> detectThreads;
+    for (auto& det : detectors) {
+        YoloDetector* detector = det.get();
+        detectThreads.emplace_back([&, detector]() {
+            std::vector<FramePacket> batch;
+            std::vector<cv::Mat> frames;
+            std::vector<size_t> batchSlots;
+            std::vector<std::vector<Detection>> results;
+            FramePacket packet;
+            while (decodeQueue.pop(packet)) {
+                // Gom batch: frame đầu chờ vô hạn, các frame sau chờ tới hết timeout
+                batch.clear();
+                batch.push_back(std::move(packet));
+                auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(batchTimeoutMs);
+                while ((int)batch.size() < batchSize && decodeQueue.popUntil(packet, deadline)) {
+                    batch.push_back(std::move(packet));
+                }
+
+                // Frame bị gate bỏ qua giữ detections rỗng, frame có detectRegion detect riêng trên crop,
+                // còn lại forward chung 1 batch
+                frames.clear();
+                batchSlots.clear();
+                for (size_t i = 0; i < batch.size(); ++i) {
+                    FramePacket& p = batch[i];
+                    if (p.skipDetect) continue;
+                    if (p.detectRegion.area() > 0) {
+                        detector->detectRoi(p.frame, p.detectRegion, p.detectInputSize, p.detections);
+                        continue;
+                    }
+                    if (!tiles.empty()) {
+                        detector->detectTiles(p.frame, tiles, p.detections);
+                        continue;
+                    }
+                    frames.push_back(p.frame);
+                    batchSlots.push_back(i);
+                }
+                if (!frames.empty()) {
+                    // swap: buffer detections cũ của packet quay về results để dùng cho batch sau
+                    detector->detectBatch(frames, results);
+                    for (size_t j = 0; j < batchSlots.size(); ++j) {
+                        batch[batchSlots[j]].detections.swap(results[j]);
+                    }
+                    frames.clear(); // Nhả tham chiếu tới frame để decode ghi đè lại được
+                }
+                for (auto& p : batch) detectQueue.push(std::move(p));
+            }
+            // Worker cuối cùng đóng queue để báo hết dữ liệu cho stage sau
+            if (--activeWorkers == 0) detectQueue.close();
+        });
+    }
+
+    // Stage 3: Sắp xếp lại thứ tự + Track (tracker phải thấy frame theo đúng thứ tự)
+    std::thread trackThread([&]() {
+        // Frame đang bay luôn nằm trong [nextIndex, nextIndex + maxInFlight) -> slot index % maxInFlight không trùng
+        std::vector<FramePacket> pending(maxInFlight);
+        std::vector<char> present(maxInFlight, 0);
+        long nextIndex = 0;
+        FramePacket packet;
+        while (detectQueue.pop(packet)) {
+            size_t slot = (size_t)(packet.index % maxInFlight);
+            pending[slot] = std::move(packet);
+            present[slot] = 1;
+            for (slot = (size_t)(nextIndex % maxInFlight); present[slot]; slot = (size_t)(nextIndex % maxInFlight)) {
+                present[slot] = 0;
+                trackFn(pending[slot]);
+                sinkQueue.push(std::move(pending[slot]));
+                ++nextIndex;
+                {
+                    std::lock_guard<std::mutex> lock(flightMtx);
+                    trackedCount = nextIndex;
+                }
+                flightCv.notify_one();
+            }
+        }
+        sinkQueue.close();
+    });
+
+    // Stage 4: Encode (trên luồng hiện tại)
+    long processed = 0;
+    FramePacket packet;
+    while (sinkQueue.pop(packet)) {
+        sinkFn(packet);
+        ++processed;
+        freePackets.tryPush(std::move(packet));
+    }
+
+    decodeThread.join();
+    for (auto& t : detectThreads) t.join();
+    trackThread.join();
+    return processed;
+}
+
+long Pipeline::run(cv::VideoCapture& cap, const DetectFn& detectFn, const StageFn& trackFn, const StageFn& sinkFn) {
+    if (detectors.empty()) return 0;
+    YoloDetector& detector = *detectors.front();
+    return runInOrder(cap, [&](FramePacket& packet) { detectFn(detector, packet); }, trackFn, sinkFn);
+}
+
+long Pipeline::run(cv::VideoCapture& cap, const StageFn& detectFn, const StageFn& trackFn, const StageFn& sinkFn) {
+    return runInOrder(cap, detectFn, trackFn, sinkFn);
+}
+
+long Pipeline::runInOrder(cv::VideoCapture& cap, const StageFn& detectFn, const StageFn& trackFn,
+                          const StageFn& sinkFn) {
+    BoundedQueue<FramePacket> decodeQueue(queueCapacity);
+    BoundedQueue<FramePacket> sinkQueue(queueCapacity);
+    BoundedQueue<FramePacket> freePackets(2 * queueCapacity + 4);
+
+    // Stage 1: Decode
+    std::thread decodeThread([&]() {
+        long index = 0;
+        FramePacket packet;
+        while (true) {
+            freePackets.tryPop(packet); // Không có packet rảnh thì dùng lại packet vừa move đi (rỗng)
+            packet.recycle();
+            {
+                METRICS_SCOPE(DECODE);
+                if (!cap.read(packet.frame)) break;
+            }
+            packet.index = index++;
+            packet.timestampMs = cap.get(cv::CAP_PROP_POS_MSEC);
+            if (preDetectFn) preDetectFn(packet);
+            if (!decodeQueue.push(std::move(packet))) break;
+        }
+        decodeQueue.close();
+    });
+
+    // Stage 2: Detect + Track (queue giữ nguyên thứ tự nên không cần sắp xếp lại)
+    std::thread trackThread([&]() {
+        FramePacket packet;
+        while (decodeQueue.pop(packet)) {
+            detectFn(packet);
+            trackFn(packet);
+            sinkQueue.push(std::move(packet));
+        }
+        sinkQueue.close();
+    });
+
+    // Stage 3: Encode (trên luồng hiện tại)
+    long processed = 0;
+    FramePacket packet;
+    while (sinkQueue.pop(packet)) {
+        sinkFn(packet);
+        ++processed;
+        freePackets.tryPush(std::move(packet));
+    }
+
+    decodeThread.join();
+    trackThread.join();
+    return processed;
+}
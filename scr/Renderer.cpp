@@ -0,0 +1,46 @@
+#include "Renderer.h"
+
+namespace Renderer {
+
+void drawTrack(cv::Mat& frame, const TrackResult& result) {
+    if (!result.hasBall) return;
+
+    // Vẽ ball history
+    for (const auto& p : result.history) {
+        cv::circle(frame, p, 4, cv::Scalar(0,255,0), -1);
+    }
+    cv::rectangle(frame, result.ballBox, cv::Scalar(255,255,255), 2);
+
+    // Vẽ lại điểm bounce nếu có
+    if (result.hasBounceMarker) {
+        cv::circle(frame, result.bounceMarker, 7, cv::Scalar(0,0,255), -1); // Điểm đỏ
+        cv::circle(frame, result.bounceMarker, 9, cv::Scalar(0,0,255), 2); // Viền đỏ
+    }
+
+    // Draw vectors for debug
+    if (result.hasTrajectory) {
+        cv::arrowedLine(frame, result.trajectory[1], result.trajectory[0], cv::Scalar(200, 220, 100), 2);
+        cv::arrowedLine(frame, result.trajectory[1], result.trajectory[2], cv::Scalar(120, 255, 160), 2);
+    }
+
+    if (result.bounceDetected) {
+        cv::putText(frame, "BOUNCE DETECTED", cv::Point(50, 100), cv::FONT_HERSHEY_SIMPLEX, 1, cv::Scalar(0,0,255), 2);
+    }
+    if (result.hasBouncePoint) {
+        // Vẽ điểm bounce đỏ rõ ràng
+        cv::circle(frame, result.bouncePoint, 7, cv::Scalar(0,0,255), -1); // Điểm đỏ
+        cv::putText(frame, result.verdict, cv::Point(frame.cols - 200, 100), cv::FONT_HERSHEY_SIMPLEX, 2, cv::Scalar(0,255,255), 3);
+        if (result.zone >= 0) {
+            cv::putText(frame, CourtModel::zoneName(result.zone), cv::Point(frame.cols - 200, 140),
+                        cv::FONT_HERSHEY_SIMPLEX, 0.8, cv::Scalar(0,255,255), 2);
+        }
+    }
+}
+
+void drawCourtLine(cv::Mat& frame, const CourtLine& line, cv::Point2f outRefPoint) {
+    cv::line(frame, line.pt1, line.pt2, cv::Scalar(255, 0, 0), 3);
+    cv::circle(frame, outRefPoint, 5, cv::Scalar(0,0,255), -1);
+    cv::putText(frame, "OUT REF", outRefPoint, cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(0,0,255), 1);
+}
+
+}
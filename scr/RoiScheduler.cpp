@@ -0,0 +1,44 @@
+#include "RoiScheduler.h"
+#include "BallTracker.h"
+#include "Config.h"
+#include <algorithm>
+#include <cmath>
+
+RoiScheduler::RoiScheduler() {}
+
+cv::Rect RoiScheduler::searchWindow(cv::Point2f pos, cv::Point2f velocity, cv::Size ballSize, cv::Size frameSize) {
+    float speed = std::sqrt(velocity.x * velocity.x + velocity.y * velocity.y);
+    float side = std::max((float)Config::ROI_MIN_SIZE, Config::ROI_BALL_SCALE * std::max(ballSize.width, ballSize.height));
+    side += 2.0f * Config::ROI_VELOCITY_SCALE * speed;
+
+    int s = std::min((int)side, std::min(frameSize.width, frameSize.height));
+    int x = (int)(pos.x - s / 2.0f);
+    int y = (int)(pos.y - s / 2.0f);
+    x = std::max(0, std::min(x, frameSize.width - s));
+    y = std::max(0, std::min(y, frameSize.height - s));
+    return cv::Rect(x, y, s, s);
+}
+
+void RoiScheduler::detect(YoloDetector& detector, const cv::Mat& frame, long frameIndex, const BallTracker& tracker,
+                          std::vector<Detection>& out) {
+    cv::Point2f pos, velocity;
+    cv::Size ballSize;
+    bool refreshDue = lastFullIndex < 0 || frameIndex - lastFullIndex >= Config::ROI_REFRESH_INTERVAL;
+
+    if (!refreshDue && tracker.predictMainBall(pos, velocity, ballSize)) {
+        cv::Rect roi = searchWindow(pos, velocity, ballSize, frame.size());
+        detector.detectRoi(frame, roi, Config::ROI_INPUT_SIZE, out);
+
+        float bestConf = 0.0f;
+        for (const auto& det : out) bestConf = std::max(bestConf, det.confidence);
+        if (bestConf >= Config::ROI_MIN_CONF) {
+            ++roiCount;
+            return;
+        }
+        // Confidence trong crop thấp (bóng ra khỏi vùng dự đoán) -> detect lại cả frame này
+    }
+
+    ++fullCount;
+    lastFullIndex = frameIndex;
+    detector.detect(frame, out);
+}
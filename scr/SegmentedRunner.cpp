@@ -0,0 +1,184 @@
+#include "SegmentedRunner.h"
+#include "StageMetrics.h"
+#include "Config.h"
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+
+SegmentedRunner::SegmentedRunner(const std::string& modelPath, int workers, int overlapFrames,
+                                 const SessionOptions& options)
+    : modelPath(modelPath), workers(std::max(1, workers)), overlapFrames(std::max(0, overlapFrames)),
+      options(options) {}
+
+void SegmentedRunner::processSegment(const std::string& videoPath, YoloDetector& detector, Segment& segment) {
+    cv::VideoCapture cap(videoPath);
+    if (!cap.isOpened()) {
+        segment.failed = true;
+        return;
+    }
+
+    // Backend FFmpeg seek về keyframe gần nhất trước đó rồi decode tới đúng frame yêu cầu, nhưng không phải
+    // codec / container nào cũng seek chính xác: đọc lại vị trí thật. Seek hụt thì decode bỏ qua tới warmStart,
+    // seek quá start thì index của mọi event và mối nối đều sai -> bỏ đoạn và báo lỗi.
+    long warmStart = std::max(0L, segment.start - overlapFrames);
+    cap.set(cv::CAP_PROP_POS_FRAMES, (double)warmStart);
+    long position = (long)cap.get(cv::CAP_PROP_POS_FRAMES);
+    while (position >= 0 && position < warmStart && cap.grab()) ++position;
+    if (position < warmStart || position > segment.start) {
+        std::cerr << "Segment frames " << segment.start << "-" << segment.end - 1 << ": seek to frame " << warmStart
+                  << " landed on " << position << ", segment skipped" << std::endl;
+        segment.failed = true;
+        return;
+    }
+    warmStart = position; // Seek hơi quá (vẫn trước start): chỉ ít frame làm nóng hơn
+
+    AnalysisSession session(options);
+    TrackResult result;
+    cv::Mat frame;
+    std::vector<Detection> detections;
+    const long tailStart = segment.end - overlapFrames;
+    for (long index = warmStart; index < segment.end; ++index) {
+        {
+            METRICS_SCOPE(DECODE);
+            if (!cap.read(frame)) break;
+        }
+        double timestampMs = cap.get(cv::CAP_PROP_POS_MSEC);
+        if (index == warmStart) session.begin(frame);
+        if (session.tiles().empty()) detector.detect(frame, detections);
+        else detector.detectTiles(frame, session.tiles(), detections);
+        bool hasBall = session.track(frame, index, detections, result);
+
+        if (hasBall) {
+            segment.maxTrackId = std::max(segment.maxTrackId, result.trackId);
+            if (index < segment.start) segment.head.push_back({index, result.trackId, result.ballPos});
+            else if (index >= tailStart) segment.tail.push_back({index, result.trackId, result.ballPos});
+        }
+        if (index < segment.start) continue; // Frame làm nóng thuộc đoạn trước
+
+        // Giữ đúng những gì EventWriter ghi
+        if (result.hasBall || result.bounceDetected) {
+            segment.events.push_back({index, timestampMs, result});
+        }
+        ++segment.processed;
+        METRICS_FRAME_DONE();
+    }
+}
+
+std::vector<std::pair<int, int>> SegmentedRunner::matchSeam(const Segment& prev, const Segment& next) {
+    // Đếm số frame overlap mà bóng chính của 2 đoạn trùng vị trí, theo cặp (id đoạn sau, id đoạn trước)
+    std::map<std::pair<int, int>, int> votes;
+    size_t j = 0;
+    for (const auto& obs : next.head) {
+        while (j < prev.tail.size() && prev.tail[j].frame < obs.frame) ++j;
+        if (j == prev.tail.size()) break;
+        if (prev.tail[j].frame != obs.frame) continue;
+        if (cv::norm(prev.tail[j].pos - obs.pos) < Config::SEGMENT_MATCH_DIST) {
+            ++votes[{obs.trackId, prev.tail[j].trackId}];
+        }
+    }
+
+    // Ghép 1-1, cặp nhiều phiếu nhất trước: 2 id đoạn sau không được nối vào cùng 1 id đoạn trước
+    // (sẽ gộp 2 track khác nhau thành 1 id global)
+    std::vector<std::pair<int, std::pair<int, int>>> ranked; // (votes, (nextId, prevId))
+    for (const auto& v : votes) ranked.push_back({v.second, v.first});
+    std::stable_sort(ranked.begin(), ranked.end(),
+                     [](const auto& a, const auto& b) { return a.first > b.first; });
+    std::set<int> usedNext, usedPrev;
+    std::vector<std::pair<int, int>> matches;
+    for (const auto& r : ranked) {
+        int nextId = r.second.first, prevId = r.second.second;
+        if (usedNext.count(nextId) || usedPrev.count(prevId)) continue;
+        usedNext.insert(nextId);
+        usedPrev.insert(prevId);
+        matches.push_back({nextId, prevId});
+    }
+    return matches;
+}
+
+long SegmentedRunner::run(const std::string& videoPath, EventWriter& events) {
+    long totalFrames;
+    {
+        cv::VideoCapture probe(videoPath);
+        if (!probe.isOpened()) return -1;
+        totalFrames = (long)probe.get(cv::CAP_PROP_FRAME_COUNT);
+    }
+    if (totalFrames <= 0) return -1;
+
+    // Nhiều đoạn hơn số worker để cân tải (đoạn nhiều chuyển động chạy lâu hơn),
+    // nhưng không ngắn hơn SEGMENT_MIN_FRAMES để chi phí overlap nhỏ
+    long count = std::max(1L, std::min((long)workers * Config::SEGMENTS_PER_WORKER,
+                                       totalFrames / std::max(1, Config::SEGMENT_MIN_FRAMES)));
+    std::vector<Segment> segments(count);
+    for (long i = 0; i < count; ++i) {
+        segments[i].start = totalFrames * i / count;
+        segments[i].end = totalFrames * (i + 1) / count;
+    }
+
+    int threads = (int)std::min<long>(workers, count);
+    int cores = (int)std::thread::hardware_concurrency();
+    cv::setNumThreads(std::max(1, cores / threads));
+
+    // Ghép event theo thứ tự đoạn ngay khi đoạn đó và mọi đoạn trước đã xong: track id đoạn sau nối với
+    // đoạn trước ở mối nối, id còn lại dời lên sau id lớn nhất đã dùng để không trùng. Event của đoạn được
+    // ghi ra rồi giải phóng luôn, nên bộ nhớ không tăng theo độ dài file và output có dần trong lúc chạy.
+    std::mutex stitchMutex;
+    long nextToWrite = 0;
+    long processed = 0;
+    failed = 0;
+    int idOffset = 0;
+    std::map<int, int> prevGlobal; // id local của đoạn trước -> id global
+    auto stitch = [&](long i) {
+        Segment& seg = segments[i];
+        std::map<int, int> global;
+        if (i > 0) {
+            for (const auto& m : matchSeam(segments[i - 1], seg)) {
+                auto it = prevGlobal.find(m.second);
+                if (it != prevGlobal.end()) global[m.first] = it->second;
+            }
+            std::vector<SeamObservation>().swap(segments[i - 1].tail);
+        }
+        auto toGlobal = [&](int local) {
+            auto it = global.find(local);
+            if (it != global.end()) return it->second;
+            int id = idOffset + local;
+            global[local] = id;
+            return id;
+        };
+
+        for (auto& ev : seg.events) {
+            if (ev.track.hasBall) ev.track.trackId = toGlobal(ev.track.trackId);
+            events.write(ev.frame, ev.timestampMs, ev.track);
+        }
+        for (const auto& obs : seg.tail) toGlobal(obs.trackId);
+
+        idOffset += seg.maxTrackId + 1;
+        prevGlobal = std::move(global);
+        processed += seg.processed;
+        if (seg.failed) ++failed;
+        std::vector<FrameEvent>().swap(seg.events);
+        std::vector<SeamObservation>().swap(seg.head);
+    };
+
+    std::atomic<long> next(0);
+    std::vector<std::thread> pool;
+    for (int w = 0; w < threads; ++w) {
+        pool.emplace_back([&]() {
+            YoloDetector detector(modelPath);
+            for (long i = next++; i < count; i = next++) {
+                processSegment(videoPath, detector, segments[i]);
+
+                std::lock_guard<std::mutex> lock(stitchMutex);
+                segments[i].done = true;
+                std::cout << "Segment " << i + 1 << "/" << count << (segments[i].failed ? " FAILED" : " done")
+                          << " (frames " << segments[i].start << "-" << segments[i].end - 1 << ")" << std::endl;
+                while (nextToWrite < count && segments[nextToWrite].done) stitch(nextToWrite++);
+            }
+        });
+    }
+    for (auto& t : pool) t.join();
+    return processed;
+}
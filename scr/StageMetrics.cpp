@@ -0,0 +1,215 @@
+#include "StageMetrics.h"
+
+namespace StageMetrics {
+    const char* stageName(Stage stage) {
+        static const char* names[STAGE_COUNT] = {
+            "decode", "gate", "preprocess", "forward", "postprocess", "track", "lines", "render", "write", "events", "latency"
+        };
+        return (stage >= 0 && stage < STAGE_COUNT) ? names[stage] : "unknown";
+    }
+}
+
+#ifdef PICKLEBALL_ENABLE_METRICS
+
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace StageMetrics {
+
+namespace {
+    Histogram g_histograms[STAGE_COUNT];
+    std::atomic<int64_t> g_startNs{0};
+    std::atomic<uint64_t> g_frames{0};
+
+    // Trạng thái báo cáo định kỳ (giữ bởi g_reportMtx)
+    std::mutex g_reportMtx;
+    int64_t g_lastReportNs = 0;
+    uint64_t g_lastReportFrames = 0;
+
+    int64_t nowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    int highestBit(uint64_t v) {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanReverse64(&index, v);
+        return (int)index;
+#else
+        return 63 - __builtin_clzll(v);
+#endif
+    }
+
+    double elapsedSec() {
+        int64_t start = g_startNs.load(std::memory_order_relaxed);
+        return start == 0 ? 0.0 : (nowNs() - start) * 1e-9;
+    }
+
+    void printTable(std::ostream& os, double fps) {
+        os << "[metrics] " << g_frames.load(std::memory_order_relaxed) << " frames, "
+           << std::fixed << std::setprecision(1) << fps << " fps\n";
+        os << "  " << std::left << std::setw(12) << "stage" << std::right
+           << std::setw(10) << "count" << std::setw(10) << "p50 ms" << std::setw(10) << "p95 ms"
+           << std::setw(10) << "p99 ms" << std::setw(10) << "max ms" << "\n";
+        os << std::setprecision(3);
+        for (int s = 0; s < STAGE_COUNT; ++s) {
+            const Histogram& h = g_histograms[s];
+            if (h.count() == 0) continue;
+            os << "  " << std::left << std::setw(12) << stageName((Stage)s) << std::right
+               << std::setw(10) << h.count()
+               << std::setw(10) << h.percentileNs(0.50) * 1e-6
+               << std::setw(10) << h.percentileNs(0.95) * 1e-6
+               << std::setw(10) << h.percentileNs(0.99) * 1e-6
+               << std::setw(10) << h.maxNs() * 1e-6 << "\n";
+        }
+        os << std::defaultfloat << std::flush;
+    }
+}
+
+int Histogram::bucketOf(uint64_t ns) {
+    if (ns < (uint64_t)LINEAR) return (int)ns;
+    int e = highestBit(ns);
+    int sub = (int)(ns >> (e - SUB_BITS)) & ((1 << SUB_BITS) - 1);
+    return LINEAR + (e - SUB_BITS - 1) * (1 << SUB_BITS) + sub;
+}
+
+uint64_t Histogram::bucketMid(int index) {
+    if (index < LINEAR) return (uint64_t)index;
+    int e = (index - LINEAR) / (1 << SUB_BITS) + SUB_BITS + 1;
+    int sub = (index - LINEAR) % (1 << SUB_BITS);
+    uint64_t width = 1ull << (e - SUB_BITS);
+    uint64_t lower = ((uint64_t)((1 << SUB_BITS) + sub)) << (e - SUB_BITS);
+    return lower + width / 2;
+}
+
+void Histogram::record(uint64_t ns) {
+    buckets[bucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(ns, std::memory_order_relaxed);
+    uint64_t prev = maxValue.load(std::memory_order_relaxed);
+    while (ns > prev && !maxValue.compare_exchange_weak(prev, ns, std::memory_order_relaxed)) {}
+}
+
+double Histogram::meanNs() const {
+    uint64_t n = count();
+    return n == 0 ? 0.0 : (double)sum.load(std::memory_order_relaxed) / n;
+}
+
+uint64_t Histogram::percentileNs(double q) const {
+    uint64_t n = count();
+    if (n == 0) return 0;
+    // Hạng của phần tử cần tìm (1-based), giá trị trả về là tâm bucket chứa nó
+    uint64_t rank = (uint64_t)(q * n + 0.5);
+    if (rank < 1) rank = 1;
+    if (rank > n) rank = n;
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        seen += buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            uint64_t mid = bucketMid(i);
+            uint64_t mx = maxNs();
+            return mid < mx ? mid : mx;
+        }
+    }
+    return maxNs();
+}
+
+Histogram& histogram(Stage stage) {
+    return g_histograms[stage];
+}
+
+void markStart() {
+    if (g_startNs.load(std::memory_order_relaxed) != 0) return;
+    int64_t expected = 0;
+    g_startNs.compare_exchange_strong(expected, nowNs(), std::memory_order_relaxed);
+}
+
+void frameDone() {
+    markStart();
+    g_frames.fetch_add(1, std::memory_order_relaxed);
+}
+
+void reportPeriodic(std::ostream& os, double intervalSec) {
+    // Luồng khác đang in thì bỏ qua, không chờ
+    std::unique_lock<std::mutex> lock(g_reportMtx, std::try_to_lock);
+    if (!lock.owns_lock()) return;
+
+    int64_t now = nowNs();
+    if (g_lastReportNs == 0) {
+        g_lastReportNs = now;
+        return;
+    }
+    double dt = (now - g_lastReportNs) * 1e-9;
+    if (dt < intervalSec) return;
+
+    // fps của khoảng vừa qua, percentile tích lũy từ đầu
+    uint64_t frames = g_frames.load(std::memory_order_relaxed);
+    printTable(os, (frames - g_lastReportFrames) / dt);
+    g_lastReportNs = now;
+    g_lastReportFrames = frames;
+}
+
+void printReport(std::ostream& os) {
+    double sec = elapsedSec();
+    printTable(os, sec > 0.0 ? g_frames.load(std::memory_order_relaxed) / sec : 0.0);
+}
+
+bool writeJson(const std::string& path) {
+    std::ofstream out(path);
+    if (!out.is_open()) return false;
+
+    double sec = elapsedSec();
+    uint64_t frames = g_frames.load(std::memory_order_relaxed);
+    char buf[256];
+    std::snprintf(buf, sizeof(buf), "{\"frames\":%llu,\"elapsed_s\":%.3f,\"fps\":%.2f,\"stages\":{",
+                  (unsigned long long)frames, sec, sec > 0.0 ? frames / sec : 0.0);
+    out << buf;
+    bool first = true;
+    for (int s = 0; s < STAGE_COUNT; ++s) {
+        const Histogram& h = g_histograms[s];
+        if (h.count() == 0) continue;
+        std::snprintf(buf, sizeof(buf),
+                      "%s\"%s\":{\"count\":%llu,\"mean_ms\":%.4f,\"p50_ms\":%.4f,\"p95_ms\":%.4f,\"p99_ms\":%.4f,\"max_ms\":%.4f}",
+                      first ? "" : ",", stageName((Stage)s), (unsigned long long)h.count(), h.meanNs() * 1e-6,
+                      h.percentileNs(0.50) * 1e-6, h.percentileNs(0.95) * 1e-6,
+                      h.percentileNs(0.99) * 1e-6, h.maxNs() * 1e-6);
+        out << buf;
+        first = false;
+    }
+    out << "}}\n";
+    return true;
+}
+
+bool writeCsv(const std::string& path) {
+    std::ofstream out(path);
+    if (!out.is_open()) return false;
+
+    out << "stage,count,mean_ms,p50_ms,p95_ms,p99_ms,max_ms\n";
+    char buf[256];
+    for (int s = 0; s < STAGE_COUNT; ++s) {
+        const Histogram& h = g_histograms[s];
+        if (h.count() == 0) continue;
+        std::snprintf(buf, sizeof(buf), "%s,%llu,%.4f,%.4f,%.4f,%.4f,%.4f\n",
+                      stageName((Stage)s), (unsigned long long)h.count(), h.meanNs() * 1e-6,
+                      h.percentileNs(0.50) * 1e-6, h.percentileNs(0.95) * 1e-6,
+                      h.percentileNs(0.99) * 1e-6, h.maxNs() * 1e-6);
+        out << buf;
+    }
+    return true;
+}
+
+void reportFinal(std::ostream& os, const std::string& jsonPath, const std::string& csvPath) {
+    printReport(os);
+    if (!jsonPath.empty() && writeJson(jsonPath)) os << "Metrics written to " << jsonPath << std::endl;
+    if (!csvPath.empty() && writeCsv(csvPath)) os << "Metrics written to " << csvPath << std::endl;
+}
+
+} // namespace StageMetrics
+
+#endif // PICKLEBALL_ENABLE_METRICS
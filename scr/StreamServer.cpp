@@ -0,0 +1,249 @@
+#include "StreamServer.h"
+#include "AnalysisSession.h"
+#include "Renderer.h"
+#include "EventWriter.h"
+#include "MotionGate.h"
+#include "StageMetrics.h"
+#include "Config.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+
+struct StreamServer::Stream {
+    int id = 0;
+    StreamSource source;
+    cv::VideoCapture cap;
+    cv::VideoWriter writer;
+    std::unique_ptr<EventWriter> events;
+    std::unique_ptr<AnalysisSession> session; // Tracker, line biên, line tracking, mô hình sân của stream
+    MotionGate gate;
+
+    BoundedQueue<FramePacket> detected;
+    // Giới hạn số frame đang "bay" của stream, để 1 file đọc nhanh không chiếm hết hàng đợi chung
+    long maxInFlight = 0;
+    std::mutex flightMtx;
+    std::condition_variable flightCv;
+    long trackedCount = 0;
+    long processed = 0;
+
+    explicit Stream(size_t capacity) : detected(capacity) {}
+};
+
+StreamServer::StreamServer(const std::string& modelPath, int detectWorkers, int maxBatch, int latencyBudgetMs,
+                           size_t queueCapacity)
+    : maxBatch(std::max(1, maxBatch)), latencyBudget(std::max(0, latencyBudgetMs)), queueCapacity(queueCapacity) {
+    int workers = std::max(1, detectWorkers);
+    for (int i = 0; i < workers; ++i) {
+        detectors.push_back(std::make_unique<YoloDetector>(modelPath));
+    }
+
+    // Chia core cho các worker như Pipeline: 1 scheduler cho mọi stream thay vì mỗi stream 1 process giành CPU
+    if (workers > 1) {
+        int cores = (int)std::thread::hardware_concurrency();
+        cv::setNumThreads(std::max(1, cores / workers));
+    }
+}
+
+StreamServer::~StreamServer() = default;
+
+long StreamServer::run(const std::vector<StreamSource>& sources) {
+    std::vector<std::unique_ptr<Stream>> streams;
+    for (size_t i = 0; i < sources.size(); ++i) {
+        auto stream = std::make_unique<Stream>(queueCapacity);
+        stream->id = (int)i;
+        stream->source = sources[i];
+        if (!openStream(*stream)) {
+            std::cerr << "[stream " << i << "] Cannot open " << sources[i].source << ", skipped" << std::endl;
+            continue;
+        }
+        streams.push_back(std::move(stream));
+    }
+    if (streams.empty()) return 0;
+
+    // Hàng đợi chung đủ chỗ cho mọi stream cùng có frame chờ + 1 batch mỗi worker
+    BoundedQueue<Request> requests(std::max(queueCapacity, streams.size() + detectors.size() * maxBatch));
+    long perStream = (long)(queueCapacity + maxBatch);
+    for (auto& s : streams) s->maxInFlight = perStream;
+
+    std::atomic<int> activeDecoders((int)streams.size());
+    std::vector<std::thread> decodeThreads;
+    for (auto& s : streams) {
+        Stream* stream = s.get();
+        decodeThreads.emplace_back([&, stream]() {
+            decodeLoop(*stream, requests);
+            // Stream cuối cùng hết frame -> báo cho các worker
+            if (--activeDecoders == 0) requests.close();
+        });
+    }
+
+    std::atomic<int> activeWorkers((int)detectors.size());
+    std::vector<std::thread> detectThreads;
+    for (auto& det : detectors) {
+        YoloDetector* detector = det.get();
+        detectThreads.emplace_back([&, detector]() {
+            detectLoop(*detector, requests);
+            if (--activeWorkers == 0) {
+                for (auto& st : streams) st->detected.close();
+            }
+        });
+    }
+
+    std::vector<std::thread> trackThreads;
+    for (auto& s : streams) {
+        Stream* stream = s.get();
+        trackThreads.emplace_back([this, stream]() { trackLoop(*stream); });
+    }
+
+    for (auto& t : decodeThreads) t.join();
+    for (auto& t : detectThreads) t.join();
+    for (auto& t : trackThreads) t.join();
+
+    long total = 0;
+    for (auto& s : streams) {
+        std::cout << "[stream " << s->id << "] " << s->source.source << ": " << s->processed << " frames";
+        if (s->events->isOpen()) std::cout << ", " << s->events->written() << " events";
+        std::cout << std::endl;
+        s->cap.release();
+        s->writer.release();
+        total += s->processed;
+    }
+    return total;
+}
+
+bool StreamServer::openStream(Stream& stream) {
+    if (!stream.cap.open(stream.source.source)) return false;
+
+    int width = (int)stream.cap.get(cv::CAP_PROP_FRAME_WIDTH);
+    int height = (int)stream.cap.get(cv::CAP_PROP_FRAME_HEIGHT);
+    double fps = stream.cap.get(cv::CAP_PROP_FPS);
+    if (!stream.source.outputPath.empty()) {
+        stream.writer.open(stream.source.outputPath, cv::VideoWriter::fourcc('m','p','4','v'),
+                           fps > 0 ? fps : 30, cv::Size(width, height));
+    }
+    stream.events = std::make_unique<EventWriter>(stream.source.eventsPath);
+
+    // Không có UI cho N sân -> line dài nhất của frame đầu
+    SessionOptions options;
+    options.courtModel = courtModelEnabled;
+    options.lineTracking = lineTrackingEnabled;
+    options.tiled = false; // Batch chung giữa các stream luôn là cả frame
+    stream.session = std::make_unique<AnalysisSession>(options);
+    cv::Mat firstFrame;
+    if (stream.cap.read(firstFrame)) {
+        stream.session->begin(firstFrame);
+        if (courtModelEnabled && !stream.session->court().valid()) {
+            std::cerr << "[stream " << stream.id << "] Court calibration failed, using the longest line" << std::endl;
+        }
+        stream.cap.set(cv::CAP_PROP_POS_FRAMES, 0);
+    }
+    if (!stream.session->hasCourtLine()) {
+        std::cerr << "[stream " << stream.id << "] No court line found!" << std::endl;
+    }
+    return true;
+}
+
+void StreamServer::decodeLoop(Stream& stream, BoundedQueue<Request>& requests) {
+    long index = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(stream.flightMtx);
+            stream.flightCv.wait(lock, [&]() { return index - stream.trackedCount < stream.maxInFlight; });
+        }
+        Request request;
+        request.stream = &stream;
+        {
+            METRICS_SCOPE(DECODE);
+            if (!stream.cap.read(request.packet.frame)) break;
+        }
+        request.packet.index = index++;
+        request.packet.timestampMs = stream.cap.get(cv::CAP_PROP_POS_MSEC);
+        if (motionGateEnabled && !stream.gate.evaluate(request.packet.frame, request.packet.detectRegion,
+                                                       request.packet.detectInputSize)) {
+            // Không có chuyển động: bỏ qua scheduler, track thấy frame với detections rỗng
+            request.packet.skipDetect = true;
+            if (!stream.detected.push(std::move(request.packet))) break;
+            continue;
+        }
+        request.packet.detectRegion = cv::Rect();
+        request.deadline = std::chrono::steady_clock::now() + latencyBudget;
+        if (!requests.push(std::move(request))) break;
+    }
+}
+
+void StreamServer::detectLoop(YoloDetector& detector, BoundedQueue<Request>& requests) {
+    std::vector<Request> batch;
+    std::vector<cv::Mat> frames;
+    // Ước lượng thời gian forward 1 batch (EMA), trừ khỏi hạn chót để kết quả ra kịp hạn
+    std::chrono::steady_clock::duration forwardEstimate(0);
+    Request request;
+    while (requests.pop(request)) {
+        // Frame đầu là frame cũ nhất (FIFO) -> hạn của nó là hạn của cả batch.
+        // Quá hạn rồi thì vẫn lấy các frame đang sẵn trong queue nhưng không chờ thêm.
+        batch.clear();
+        batch.push_back(std::move(request));
+        auto deadline = batch.front().deadline - forwardEstimate;
+        while ((int)batch.size() < maxBatch && requests.popUntil(request, deadline)) {
+            batch.push_back(std::move(request));
+        }
+
+        frames.clear();
+        for (auto& r : batch) frames.push_back(r.packet.frame);
+        auto start = std::chrono::steady_clock::now();
+        auto results = detector.detectBatch(frames);
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        forwardEstimate = forwardEstimate == std::chrono::steady_clock::duration(0)
+                              ? elapsed : (forwardEstimate * 7 + elapsed) / 8;
+
+        for (size_t i = 0; i < batch.size(); ++i) {
+            batch[i].packet.detections = std::move(results[i]);
+            batch[i].stream->detected.push(std::move(batch[i].packet));
+        }
+    }
+}
+
+void StreamServer::trackLoop(Stream& stream) {
+    // Worker trả frame không theo thứ tự -> sắp xếp lại như Pipeline, rồi track + encode trên cùng luồng
+    std::map<long, FramePacket> pending;
+    long nextIndex = 0;
+    AnalysisSession& session = *stream.session;
+    FramePacket packet;
+    while (stream.detected.pop(packet)) {
+        pending.emplace(packet.index, std::move(packet));
+        for (auto it = pending.find(nextIndex); it != pending.end(); it = pending.find(nextIndex)) {
+            FramePacket& p = it->second;
+
+            session.track(p.frame, p.index, p.detections, p.track);
+
+            {
+                METRICS_SCOPE(EVENTS);
+                stream.events->write(p.index, p.timestampMs, p.track);
+            }
+            if (stream.writer.isOpened()) {
+                {
+                    METRICS_SCOPE(RENDER);
+                    Renderer::drawTrack(p.frame, p.track);
+                    if (session.hasCourtLine()) {
+                        Renderer::drawCourtLine(p.frame, session.courtLine(), session.outRef());
+                    }
+                }
+                METRICS_SCOPE(WRITE);
+                stream.writer.write(p.frame);
+            }
+            METRICS_FRAME_DONE();
+            METRICS_REPORT_PERIODIC(std::cout, Config::METRICS_INTERVAL_S);
+
+            pending.erase(it);
+            ++nextIndex;
+            ++stream.processed;
+            {
+                std::lock_guard<std::mutex> lock(stream.flightMtx);
+                stream.trackedCount = nextIndex;
+            }
+            stream.flightCv.notify_one();
+        }
+    }
+}
@@ -0,0 +1,405 @@
+#include "SyntheticRally.h"
+#include "CourtModel.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
+namespace {
+    const float GRAVITY = 9.81f;
+    const float BALL_RADIUS_M = 0.037f;         // Bóng pickleball đường kính ~74 mm
+    const float BOUNCE_RESTITUTION = 0.6f;      // Vận tốc dọc sau / trước khi chạm đất
+    const float BOUNCE_FRICTION = 0.7f;         // Vận tốc ngang sau / trước khi chạm đất
+    const float MIN_BOUNCE_SPEED = 1.5f;        // Chạm đất chậm hơn (m/s) không tính là bounce
+    const cv::Scalar BALL_COLOR(50, 235, 225);  // Vàng chanh
+    const cv::Scalar DISTRACTOR_COLOR(45, 215, 205);
+    const cv::Scalar LINE_COLOR(235, 235, 235);
+
+    cv::Point toPx(cv::Point2f p) {
+        return cv::Point(cvRound(p.x), cvRound(p.y));
+    }
+
+    cv::Point3f normalized(const cv::Point3f& p) {
+        float n = std::sqrt(p.dot(p));
+        return n > 0.0f ? p * (1.0f / n) : p;
+    }
+
+    bool insideCourt(cv::Point2f p) {
+        return p.x >= 0.0f && p.x <= CourtModel::WIDTH && p.y >= 0.0f && p.y <= CourtModel::LENGTH;
+    }
+}
+
+SyntheticRally::SyntheticRally(const Options& options) : opts(options) {
+    frameCount = (long)(opts.seconds * opts.fps);
+    cv::RNG rng(opts.seed);
+    setupCamera();
+
+    const float W = CourtModel::WIDTH;
+    const float L = CourtModel::LENGTH;
+    for (int i = 0; i < opts.distractors; ++i) {
+        Distractor d;
+        if (i % 2 == 0) {
+            // Bóng nằm yên ngoài sân, 2 bên sideline
+            float x = (i / 2) % 2 == 0 ? rng.uniform(-2.5f, -0.6f) : rng.uniform(W + 0.6f, W + 2.5f);
+            d.p0 = cv::Point3f(x, rng.uniform(0.5f, L - 0.5f), 0.0f);
+            d.speed = 0.0f;
+        } else {
+            // Bóng lăn qua lại phía sau baseline xa (sân bên cạnh)
+            d.p0 = cv::Point3f(rng.uniform(-2.0f, W + 2.0f), L + rng.uniform(1.5f, 3.0f), 0.0f);
+            d.speed = rng.uniform(0.5f, 2.0f);
+        }
+        d.minX = -2.5f;
+        d.maxX = W + 2.5f;
+        distractors.push_back(d);
+    }
+    shirtColors[0] = cv::Scalar(40, 40, 200);
+    shirtColors[1] = cv::Scalar(200, 120, 30);
+
+    simulate(rng);
+    buildBackground(rng);
+}
+
+void SyntheticRally::setupCamera() {
+    const float W = CourtModel::WIDTH;
+    const float L = CourtModel::LENGTH;
+    camPos = cv::Point3f(W / 2, -Config::SYNTH_CAMERA_BACK_M, Config::SYNTH_CAMERA_HEIGHT_M);
+    camForward = normalized(cv::Point3f(W / 2, L / 2, 0.0f) - camPos);
+    camRight = normalized(camForward.cross(cv::Point3f(0.0f, 0.0f, 1.0f)));
+    camDown = camForward.cross(camRight);
+
+    // Chiếu với focal = 1 rồi co giãn để sân (kèm 3 m phía trên baseline xa cho bóng bổng) nằm giữa frame
+    focal = 1.0f;
+    principal = cv::Point2f(0.0f, 0.0f);
+    const cv::Point3f extents[] = {
+        {0, 0, 0}, {W, 0, 0}, {W, L, 0}, {0, L, 0}, {0, L, 3.0f}, {W, L, 3.0f}};
+    float umin = 1e9f, umax = -1e9f, vmin = 1e9f, vmax = -1e9f;
+    for (const auto& p : extents) {
+        cv::Point2f q = project(p);
+        umin = std::min(umin, q.x);
+        umax = std::max(umax, q.x);
+        vmin = std::min(vmin, q.y);
+        vmax = std::max(vmax, q.y);
+    }
+    const cv::Size& size = opts.frameSize;
+    focal = std::min(0.62f * size.width / (umax - umin), 0.78f * size.height / (vmax - vmin));
+    principal = cv::Point2f(size.width / 2.0f - focal * (umin + umax) / 2, 0.95f * size.height - focal * vmax);
+
+    corners.clear();
+    for (int i = 0; i < 4; ++i) corners.push_back(project(extents[i]));
+}
+
+cv::Point2f SyntheticRally::project(const cv::Point3f& courtPt) const {
+    cv::Point3f d = courtPt - camPos;
+    float zc = d.dot(camForward);
+    return cv::Point2f(focal * d.dot(camRight) / zc + principal.x, focal * d.dot(camDown) / zc + principal.y);
+}
+
+float SyntheticRally::pixelRadius(const cv::Point3f& courtPt, float radiusM) const {
+    return focal * radiusM / (courtPt - camPos).dot(camForward);
+}
+
+void SyntheticRally::simulate(cv::RNG& rng) {
+    const float W = CourtModel::WIDTH;
+    const float L = CourtModel::LENGTH;
+    cv::Rect frameRect(cv::Point(0, 0), opts.frameSize);
+
+    auto addBounce = [&](double t, cv::Point2f courtPos) {
+        cv::Point2f img = project(cv::Point3f(courtPos.x, courtPos.y, 0.0f));
+        if (!frameRect.contains(toPx(img))) return; // Camera không thấy điểm chạm
+        bounceTruth.push_back({t * opts.fps, img, courtPos, insideCourt(courtPos)});
+    };
+
+    double t = 1.0;
+    bool nearServes = true;
+    const double end = opts.seconds - 1.0;
+    while (t < end) {
+        bool fromNear = nearServes;
+        nearServes = !nearServes;
+        cv::Point3f p(rng.uniform(1.0f, W - 1.0f), fromNear ? rng.uniform(-1.0f, 0.0f) : L + rng.uniform(0.0f, 1.0f),
+                      0.9f);
+        int shots = rng.uniform(2, 10);
+        for (int s = 0; s < shots && t < end; ++s) {
+            bool last = s == shots - 1;
+            // Điểm đích ở nửa sân đối diện; cú cuối có thể ra ngoài, 1 phần cú đánh sát vạch biên
+            float yNear = fromNear ? L / 2 + 0.5f : 0.1f;
+            float yFar = fromNear ? L - 0.1f : L / 2 - 0.5f;
+            cv::Point2f target(rng.uniform(0.2f, W - 0.2f), rng.uniform(yNear, yFar));
+            float baseline = fromNear ? L : 0.0f;
+            float outward = fromNear ? 1.0f : -1.0f;
+            if (last && rng.uniform(0.0f, 1.0f) < Config::SYNTH_OUT_FRACTION) {
+                if (rng.uniform(0.0f, 1.0f) < 0.5f) target.y = baseline + outward * rng.uniform(0.1f, 1.2f);
+                else target.x = rng.uniform(0.0f, 1.0f) < 0.5f ? -rng.uniform(0.1f, 0.8f) : W + rng.uniform(0.1f, 0.8f);
+            } else if (rng.uniform(0.0f, 1.0f) < Config::SYNTH_CLOSE_CALL_FRACTION) {
+                float offset = rng.uniform(-0.15f, 0.15f);
+                if (rng.uniform(0.0f, 1.0f) < 0.5f) target.y = baseline + outward * offset;
+                else target.x = rng.uniform(0.0f, 1.0f) < 0.5f ? -offset : W + offset;
+            }
+
+            // Parabol từ p tới target (z = 0) trong tf giây
+            float tf = rng.uniform(0.8f, 1.3f);
+            cv::Point3f v((target.x - p.x) / tf, (target.y - p.y) / tf, (-p.z + 0.5f * GRAVITY * tf * tf) / tf);
+            segments.push_back({t, t + tf, p, v});
+            t += tf;
+            addBounce(t, target);
+
+            float impact = GRAVITY * tf - v.z;
+            cv::Point3f bounced(v.x * BOUNCE_FRICTION, v.y * BOUNCE_FRICTION, impact * BOUNCE_RESTITUTION);
+            cv::Point3f ground(target.x, target.y, 0.0f);
+            if (!last) {
+                // Bị đánh trả khi bóng nảy lên, trước khi xuống thấp hơn 0.3 m
+                float th = rng.uniform(0.25f, 0.45f);
+                float vz = bounced.z;
+                float disc = vz * vz - 2.0f * GRAVITY * 0.3f;
+                if (disc > 0.0f) th = std::min(th, (vz + std::sqrt(disc)) / GRAVITY);
+                segments.push_back({t, t + th, ground, bounced});
+                p = ground + bounced * th + cv::Point3f(0.0f, 0.0f, -0.5f * GRAVITY * th * th);
+                t += th;
+                fromNear = !fromNear;
+            } else {
+                // Bóng chết: nảy tiếp tới khi hết SYNTH_DEAD_BALL_S rồi biến khỏi khung hình
+                double remaining = Config::SYNTH_DEAD_BALL_S;
+                cv::Point3f pos = ground;
+                cv::Point3f vel = bounced;
+                while (remaining > 0.0 && vel.z > 0.5f) {
+                    float tb = 2.0f * vel.z / GRAVITY;
+                    float dt = (float)std::min<double>(tb, remaining);
+                    segments.push_back({t, t + dt, pos, vel});
+                    t += dt;
+                    remaining -= dt;
+                    if (dt < tb) break;
+                    pos = cv::Point3f(pos.x + vel.x * tb, pos.y + vel.y * tb, 0.0f);
+                    if (vel.z > MIN_BOUNCE_SPEED) addBounce(t, cv::Point2f(pos.x, pos.y));
+                    vel = cv::Point3f(vel.x * BOUNCE_FRICTION, vel.y * BOUNCE_FRICTION, vel.z * BOUNCE_RESTITUTION);
+                }
+            }
+        }
+        t += rng.uniform(1.5, 3.0); // Nghỉ giữa 2 rally, không có bóng
+    }
+}
+
+void SyntheticRally::buildBackground(cv::RNG& rng) {
+    const float W = CourtModel::WIDTH;
+    const float L = CourtModel::LENGTH;
+    const cv::Size& size = opts.frameSize;
+    background.create(size, CV_8UC3);
+    background.setTo(cv::Scalar(50, 100, 45));
+
+    auto fillCourtQuad = [&](cv::Mat& dst, float x0, float y0, float x1, float y1, const cv::Scalar& color) {
+        cv::Point quad[4] = {toPx(project({x0, y0, 0})), toPx(project({x1, y0, 0})),
+                             toPx(project({x1, y1, 0})), toPx(project({x0, y1, 0}))};
+        cv::fillConvexPoly(dst, quad, 4, color, cv::LINE_AA);
+    };
+    // Phần sân ngoài vạch (xanh lá) rồi mặt sân (xanh dương)
+    fillCourtQuad(background, -3.0f, -3.5f, W + 3.0f, L + 3.5f, cv::Scalar(70, 130, 60));
+    const cv::Scalar courtColor(150, 95, 45);
+    fillCourtQuad(background, 0.0f, 0.0f, W, L, courtColor);
+    shadowColor = cv::Scalar(courtColor[0] * 0.45, courtColor[1] * 0.45, courtColor[2] * 0.45);
+
+    // Nhiễu cảm biến cố định: trên mặt sân là vân, không đổi giữa các frame nên không tạo chuyển động
+    cv::Mat noise(size, CV_8UC3);
+    rng.fill(noise, cv::RNG::UNIFORM, cv::Scalar(0, 0, 0), cv::Scalar(18, 18, 18));
+    background += noise;
+
+    // Vạch trắng nằm trong kích thước sân, dày tối thiểu SYNTH_MIN_LINE_PX để qua được morph open 7x7
+    // của LineDetector như vạch thật ở độ phân giải detect
+    const float hw = CourtModel::LINE_WIDTH / 2;
+    const float K = CourtModel::KITCHEN_DEPTH;
+    auto drawLine = [&](cv::Point3f a, cv::Point3f b) {
+        int thickness = std::max(Config::SYNTH_MIN_LINE_PX,
+                                 cvRound(2.0f * pixelRadius((a + b) * 0.5f, hw)));
+        cv::line(background, toPx(project(a)), toPx(project(b)), LINE_COLOR, thickness, cv::LINE_AA);
+    };
+    drawLine({0, hw, 0}, {W, hw, 0});                       // Baseline gần
+    drawLine({0, L - hw, 0}, {W, L - hw, 0});               // Baseline xa
+    drawLine({hw, 0, 0}, {hw, L, 0});                       // Sideline
+    drawLine({W - hw, 0, 0}, {W - hw, L, 0});
+    drawLine({0, L / 2 - K + hw, 0}, {W, L / 2 - K + hw, 0}); // Kitchen line
+    drawLine({0, L / 2 + K - hw, 0}, {W, L / 2 + K - hw, 0});
+    drawLine({W / 2, 0, 0}, {W / 2, L / 2 - K, 0});         // Center line
+    drawLine({W / 2, L / 2 + K, 0}, {W / 2, L, 0});
+
+    // Lưới: dải tối bán trong suốt, không có vạch trắng trên mép để không thành line biên giả
+    cv::Mat overlay = background.clone();
+    cv::Point net[4] = {toPx(project({-0.3f, L / 2, 0})), toPx(project({W + 0.3f, L / 2, 0})),
+                        toPx(project({W + 0.3f, L / 2, 0.91f})), toPx(project({-0.3f, L / 2, 0.91f}))};
+    cv::fillConvexPoly(overlay, net, 4, cv::Scalar(30, 30, 30), cv::LINE_AA);
+    cv::addWeighted(background, 0.5, overlay, 0.5, 0.0, background);
+}
+
+bool SyntheticRally::ballAt(double t, cv::Point3f& pos) const {
+    auto it = std::upper_bound(segments.begin(), segments.end(), t,
+                               [](double value, const Segment& s) { return value < s.t0; });
+    if (it == segments.begin()) return false;
+    const Segment& s = *(it - 1);
+    if (t > s.t1) return false;
+    float dt = (float)(t - s.t0);
+    pos = s.p0 + s.v0 * dt + cv::Point3f(0.0f, 0.0f, -0.5f * GRAVITY * dt * dt);
+    return true;
+}
+
+cv::Point3f SyntheticRally::distractorAt(const Distractor& d, double t) const {
+    if (d.speed == 0.0f) return d.p0;
+    float span = d.maxX - d.minX;
+    float s = std::fmod(d.p0.x - d.minX + d.speed * (float)t, 2.0f * span);
+    float x = s < span ? d.minX + s : d.maxX - (s - span);
+    return cv::Point3f(x, d.p0.y, 0.0f);
+}
+
+cv::Point3f SyntheticRally::playerAt(int side, double t) const {
+    const float W = CourtModel::WIDTH;
+    const float L = CourtModel::LENGTH;
+    float ft = (float)t;
+    if (side == 0) return cv::Point3f(W / 2 + 2.0f * std::sin(0.8f * ft + 1.3f), -1.0f + 0.6f * std::sin(0.5f * ft), 0);
+    return cv::Point3f(W / 2 + 2.0f * std::sin(0.7f * ft + 0.4f), L + 1.0f + 0.6f * std::sin(0.45f * ft + 2.0f), 0);
+}
+
+SyntheticRally::BallTruth SyntheticRally::ball(long frameIndex) const {
+    BallTruth truth;
+    cv::Point3f pos;
+    if (!ballAt(frameIndex / opts.fps, pos)) return truth;
+    truth.courtPos = pos;
+    truth.imagePos = project(pos);
+    truth.radius = pixelRadius(pos, BALL_RADIUS_M);
+    truth.visible = cv::Rect(cv::Point(0, 0), opts.frameSize).contains(toPx(truth.imagePos));
+    return truth;
+}
+
+void SyntheticRally::render(long frameIndex, cv::Mat& frame) const {
+    background.copyTo(frame);
+    double t = frameIndex / opts.fps;
+
+    // Người chơi: chân, thân (áo màu), đầu
+    for (int side = 0; side < 2; ++side) {
+        cv::Point3f p = playerAt(side, t);
+        int width = std::max(3, cvRound(2.0f * pixelRadius(p + cv::Point3f(0, 0, 1.0f), 0.22f)));
+        cv::Point feet = toPx(project(p));
+        cv::Point hip = toPx(project(p + cv::Point3f(0, 0, 0.9f)));
+        cv::Point shoulder = toPx(project(p + cv::Point3f(0, 0, 1.45f)));
+        cv::Point3f headPos = p + cv::Point3f(0, 0, 1.6f);
+        cv::line(frame, feet, hip, cv::Scalar(60, 60, 60), std::max(2, width * 2 / 3), cv::LINE_AA);
+        cv::line(frame, hip, shoulder, shirtColors[side], width, cv::LINE_AA);
+        cv::circle(frame, toPx(project(headPos)), std::max(2, cvRound(pixelRadius(headPos, 0.11f))),
+                   cv::Scalar(120, 160, 210), -1, cv::LINE_AA);
+    }
+
+    for (const Distractor& d : distractors) {
+        cv::Point3f p = distractorAt(d, t);
+        cv::circle(frame, toPx(project(p)), std::max(2, cvRound(pixelRadius(p, BALL_RADIUS_M))), DISTRACTOR_COLOR,
+                   -1, cv::LINE_AA);
+    }
+
+    cv::Point3f pos;
+    if (!ballAt(t, pos)) return;
+    int r = std::max(2, cvRound(pixelRadius(pos, BALL_RADIUS_M)));
+    if (opts.shadows) {
+        cv::Point3f ground(pos.x, pos.y, 0.0f);
+        int rs = std::max(2, cvRound(pixelRadius(ground, BALL_RADIUS_M)));
+        cv::ellipse(frame, toPx(project(ground)), cv::Size(rs * 3 / 2, std::max(1, rs * 2 / 3)), 0, 0, 360,
+                    shadowColor, -1, cv::LINE_AA);
+    }
+    // Nhoè chuyển động: vệt từ vị trí giữa thời gian phơi sáng (nửa frame) tới vị trí hiện tại
+    cv::Point c = toPx(project(pos));
+    cv::Point3f prev;
+    if (ballAt(t - 0.5 / opts.fps, prev)) {
+        cv::Point p = toPx(project(prev));
+        if (p != c) cv::line(frame, p, c, BALL_COLOR, 2 * r, cv::LINE_AA);
+    }
+    cv::circle(frame, c, r, BALL_COLOR, -1, cv::LINE_AA);
+}
+
+void SyntheticRally::distractorBoxes(long frameIndex, std::vector<cv::Rect>& out) const {
+    out.clear();
+    double t = frameIndex / opts.fps;
+    cv::Rect frameRect(cv::Point(0, 0), opts.frameSize);
+    for (const Distractor& d : distractors) {
+        cv::Point3f p = distractorAt(d, t);
+        cv::Point c = toPx(project(p));
+        int r = std::max(2, cvRound(pixelRadius(p, BALL_RADIUS_M)));
+        cv::Rect box(c.x - r, c.y - r, 2 * r, 2 * r);
+        if ((box & frameRect).area() > 0) out.push_back(box);
+    }
+    cv::Point3f pos;
+    if (opts.shadows && ballAt(t, pos)) {
+        cv::Point3f ground(pos.x, pos.y, 0.0f);
+        cv::Point c = toPx(project(ground));
+        int rs = std::max(2, cvRound(pixelRadius(ground, BALL_RADIUS_M)));
+        cv::Rect box(c.x - rs * 3 / 2, c.y - rs * 2 / 3, rs * 3, std::max(2, rs * 4 / 3));
+        if ((box & frameRect).area() > 0) out.push_back(box);
+    }
+}
+
+SyntheticRally::Score SyntheticRally::score(const std::vector<BounceCall>& calls) const {
+    Score s;
+    s.truthBounces = (int)bounceTruth.size();
+    s.calls = (int)calls.size();
+
+    // Ghép tham lam theo độ lệch thời gian tăng dần, mỗi bounce thật / call dùng tối đa 1 lần
+    const double window = Config::SYNTH_MATCH_WINDOW_S * opts.fps;
+    struct Pair { double dt; int truth, call; };
+    std::vector<Pair> pairs;
+    for (int i = 0; i < s.truthBounces; ++i) {
+        for (int j = 0; j < s.calls; ++j) {
+            double dt = std::abs(calls[j].frame - bounceTruth[i].frame);
+            if (dt <= window) pairs.push_back({dt, i, j});
+        }
+    }
+    std::sort(pairs.begin(), pairs.end(), [](const Pair& a, const Pair& b) { return a.dt < b.dt; });
+    std::vector<bool> truthUsed(s.truthBounces, false), callUsed(s.calls, false);
+
+    std::vector<double> pixelErrors;
+    double meterSum = 0.0, timingSum = 0.0;
+    int meterCount = 0;
+    for (const Pair& p : pairs) {
+        if (truthUsed[p.truth] || callUsed[p.call]) continue;
+        truthUsed[p.truth] = callUsed[p.call] = true;
+        const BounceTruth& truth = bounceTruth[p.truth];
+        const BounceCall& call = calls[p.call];
+        ++s.matched;
+        timingSum += p.dt;
+        if (call.hasPoint) pixelErrors.push_back(cv::norm(call.imagePos - truth.imagePos));
+        if (call.hasCourtPos) {
+            meterSum += cv::norm(call.courtPos - truth.courtPos);
+            ++meterCount;
+        }
+        bool calledIn = call.verdict == "IN" || call.verdict == "ON LINE";
+        bool calledOut = call.verdict == "OUT";
+        if ((truth.in && calledIn) || (!truth.in && calledOut)) ++s.correctCalls;
+        else if (truth.in && calledOut) ++s.inCalledOut;
+        else if (!truth.in && calledIn) ++s.outCalledIn;
+    }
+
+    s.precision = s.calls > 0 ? (double)s.matched / s.calls : 0.0;
+    s.recall = s.truthBounces > 0 ? (double)s.matched / s.truthBounces : 0.0;
+    s.timingErrorFrames = s.matched > 0 ? timingSum / s.matched : 0.0;
+    s.callAccuracy = s.matched > 0 ? (double)s.correctCalls / s.matched : 0.0;
+    s.contactErrorM = meterCount > 0 ? meterSum / meterCount : 0.0;
+    if (!pixelErrors.empty()) {
+        double sum = 0.0;
+        for (double e : pixelErrors) sum += e;
+        s.contactErrorPx = sum / pixelErrors.size();
+        std::sort(pixelErrors.begin(), pixelErrors.end());
+        s.contactErrorPxP95 = pixelErrors[std::min(pixelErrors.size() - 1, (size_t)(pixelErrors.size() * 0.95))];
+    }
+    return s;
+}
+
+bool SyntheticRally::writeTruth(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out.is_open()) return false;
+
+    char buf[384];
+    std::snprintf(buf, sizeof(buf),
+                  "{\"width\":%d,\"height\":%d,\"fps\":%.3f,\"frames\":%ld,\"seed\":%llu,\"court_corners\":"
+                  "[[%.1f,%.1f],[%.1f,%.1f],[%.1f,%.1f],[%.1f,%.1f]]}\n",
+                  opts.frameSize.width, opts.frameSize.height, opts.fps, frameCount, (unsigned long long)opts.seed,
+                  corners[0].x, corners[0].y, corners[1].x, corners[1].y, corners[2].x, corners[2].y,
+                  corners[3].x, corners[3].y);
+    out << buf;
+    for (const BounceTruth& b : bounceTruth) {
+        std::snprintf(buf, sizeof(buf),
+                      "{\"frame_exact\":%.2f,\"x\":%.1f,\"y\":%.1f,\"court_m\":[%.3f,%.3f],\"verdict\":\"%s\"}\n",
+                      b.frame, b.imagePos.x, b.imagePos.y, b.courtPos.x, b.courtPos.y, b.in ? "IN" : "OUT");
+        out << buf;
+    }
+    return true;
+}
@@ -0,0 +1,182 @@
+#include "TrajectoryFitter.h"
+#include "Config.h"
+#include <cmath>
+
+static_assert(Config::TRAJ_CONFIRM_POINTS >= 1 && Config::TRAJ_CONFIRM_POINTS <= 4,
+              "TRAJ_CONFIRM_POINTS must fit the pending buffer");
+
+void QuadraticRls::reset(double c2Prior, double c2Var) {
+    theta[0] = 0.0;
+    theta[1] = 0.0;
+    theta[2] = c2Prior;
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j) P[i][j] = 0.0;
+    P[0][0] = 1e6; // Vị trí (pixel^2)
+    P[1][1] = 1e4; // Vận tốc (pixel/frame)^2
+    P[2][2] = c2Var;
+}
+
+void QuadraticRls::update(double t, double value) {
+    const double phi[3] = {1.0, t, t * t};
+    double Pphi[3];
+    for (int i = 0; i < 3; ++i) Pphi[i] = P[i][0] * phi[0] + P[i][1] * phi[1] + P[i][2] * phi[2];
+    double denom = Config::TRAJ_MEASUREMENT_VAR + phi[0] * Pphi[0] + phi[1] * Pphi[1] + phi[2] * Pphi[2];
+    double err = value - (theta[0] * phi[0] + theta[1] * phi[1] + theta[2] * phi[2]);
+    for (int i = 0; i < 3; ++i) {
+        double k = Pphi[i] / denom;
+        theta[i] += k * err;
+    }
+    // P = P - (P phi)(P phi)^T / denom (P đối xứng)
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j) P[i][j] -= Pphi[i] * Pphi[j] / denom;
+}
+
+void TrajectoryFitter::Segment::start(double origin, const Segment* prior) {
+    t0 = origin;
+    lastT = origin;
+    n = 0;
+    recentHead = 0;
+    recentCount = 0;
+    if (prior) {
+        // Độ cong (c2) không đổi khi dời gốc thời gian -> dùng thẳng làm prior
+        x.reset(prior->x.theta[2], Config::TRAJ_CURVATURE_VAR);
+        y.reset(prior->y.theta[2], Config::TRAJ_CURVATURE_VAR);
+    } else {
+        x.reset(0.0, 1e2);
+        y.reset(0.0, 1e2);
+    }
+}
+
+void TrajectoryFitter::Segment::add(double t, cv::Point2f p) {
+    Sample& s = recent[recentHead];
+    s.t = t;
+    s.pos = p;
+    s.x = x;
+    s.y = y;
+    s.lastT = lastT;
+    recentHead = (recentHead + 1) % RECENT;
+    if (recentCount < RECENT) ++recentCount;
+
+    x.update(t - t0, p.x);
+    y.update(t - t0, p.y);
+    lastT = t;
+    ++n;
+}
+
+void TrajectoryFitter::Segment::rollback(int k) {
+    const Sample& s = fromEnd(k);
+    x = s.x;
+    y = s.y;
+    lastT = s.lastT;
+    n -= k;
+    recentHead = (recentHead - k + RECENT) % RECENT;
+    recentCount -= k;
+}
+
+void TrajectoryFitter::reset() {
+    active = false;
+    pendingCount = 0;
+}
+
+float TrajectoryFitter::tolerance(double t) const {
+    // Độ bất định của dự đoán theo hiệp phương sai RLS: đoạn ít điểm hoặc ngoại suy xa (mất detection) -> rộng hơn
+    double var = current.x.variance(t - current.t0) + current.y.variance(t - current.t0) + 2.0 * Config::TRAJ_MEASUREMENT_VAR;
+    return std::max(Config::TRAJ_BREAK_PX, Config::TRAJ_BREAK_SIGMA * (float)std::sqrt(var));
+}
+
+double TrajectoryFitter::contactTime(const Segment& before, const Segment& after, double lo, double hi) {
+    auto f = [&](double t) { return before.y.eval(t - before.t0) - after.y.eval(t - after.t0); };
+    double flo = f(lo), fhi = f(hi);
+    if (flo * fhi <= 0.0) {
+        for (int i = 0; i < 30; ++i) {
+            double mid = 0.5 * (lo + hi);
+            double fm = f(mid);
+            if (flo * fm <= 0.0) {
+                hi = mid;
+            } else {
+                lo = mid;
+                flo = fm;
+            }
+        }
+        return 0.5 * (lo + hi);
+    }
+    // Không cắt nhau trong khoảng (nhiễu): lấy thời điểm 2 đoạn gần nhau nhất
+    double best = lo, bestDist = 1e30;
+    for (int i = 0; i <= 16; ++i) {
+        double t = lo + (hi - lo) * i / 16.0;
+        double d = cv::norm(before.eval(t) - after.eval(t));
+        if (d < bestDist) {
+            bestDist = d;
+            best = t;
+        }
+    }
+    return best;
+}
+
+bool TrajectoryFitter::add(double t, cv::Point2f pos, Bounce& out) {
+    // Mất bóng quá lâu -> bắt đầu quỹ đạo mới
+    if (!active || t - current.lastT > Config::TRAJ_MAX_GAP) {
+        current.start(t, nullptr);
+        current.add(t, pos);
+        active = true;
+        pendingCount = 0;
+        ++segmentCount;
+        return false;
+    }
+
+    // Đoạn chưa đủ điểm để dự đoán tin cậy
+    if (current.n < Config::TRAJ_MIN_POINTS) {
+        current.add(t, pos);
+        return false;
+    }
+
+    if (cv::norm(pos - current.eval(t)) <= tolerance(t)) {
+        // Khớp đoạn hiện tại; điểm lệch đang chờ (nếu có) chỉ là nhiễu detection
+        current.add(t, pos);
+        pendingCount = 0;
+        return false;
+    }
+
+    pendingT[pendingCount] = t;
+    pendingPos[pendingCount] = pos;
+    if (++pendingCount < Config::TRAJ_CONFIRM_POINTS) return false;
+
+    // Đủ điểm lệch liên tiếp -> ngắt đoạn, đoạn mới giữ độ cong của đoạn cũ làm prior
+    candidate.start(pendingT[0], &current);
+    for (int i = 0; i < pendingCount; ++i) candidate.add(pendingT[i], pendingPos[i]);
+
+    // Điểm cuối của đoạn cũ ngay sau lúc chạm có thể vẫn lọt ngưỡng: điểm nào khớp đoạn mới hơn
+    // thì trả lại (rollback RLS đoạn cũ) và chuyển sang đoạn mới
+    int moved = 0;
+    while (moved < current.recentCount - 1 && current.n - moved > Config::TRAJ_MIN_POINTS) {
+        // So với dự đoán của đoạn cũ trước khi có điểm này (trạng thái RLS lưu trong ring)
+        const Segment::Sample& s = current.fromEnd(moved + 1);
+        cv::Point2f oldPred((float)s.x.eval(s.t - current.t0), (float)s.y.eval(s.t - current.t0));
+        if (cv::norm(s.pos - candidate.eval(s.t)) >= cv::norm(s.pos - oldPred)) break;
+        ++moved;
+    }
+    if (moved > 0) {
+        double movedT[RECENT];
+        cv::Point2f movedPos[RECENT];
+        for (int k = moved; k >= 1; --k) {
+            movedT[moved - k] = current.fromEnd(k).t;
+            movedPos[moved - k] = current.fromEnd(k).pos;
+        }
+        current.rollback(moved);
+        candidate.start(movedT[0], &current);
+        for (int i = 0; i < moved; ++i) candidate.add(movedT[i], movedPos[i]);
+        for (int i = 0; i < pendingCount; ++i) candidate.add(pendingT[i], pendingPos[i]);
+    }
+    pendingCount = 0;
+    ++segmentCount;
+
+    double tc = contactTime(current, candidate, current.lastT, candidate.t0);
+    float kick = candidate.velocity(tc).y - current.velocity(tc).y; // y ảnh hướng xuống
+    bool bounce = kick < -Config::TRAJ_MIN_KICK;
+    if (bounce) {
+        out.time = tc;
+        out.pos = (current.eval(tc) + candidate.eval(tc)) * 0.5f;
+    }
+    std::swap(current, candidate);
+    return bounce;
+}
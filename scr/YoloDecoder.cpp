@@ -0,0 +1,96 @@
+#include "YoloDecoder.h"
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Vị trí bit 1 thấp nhất (mask != 0)
+static inline int lowestBit(unsigned mask) {
+#if defined(_MSC_VER)
+    unsigned long idx;
+    _BitScanForward(&idx, mask);
+    return (int)idx;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+int YoloDecoder::compactAbove(const float* row, int n, float threshold, int* outIdx) {
+    int count = 0;
+    int i = 0;
+
+#if defined(__AVX2__)
+    const __m256 vthr = _mm256_set1_ps(threshold);
+    for (; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_loadu_ps(row + i);
+        unsigned mask = (unsigned)_mm256_movemask_ps(_mm256_cmp_ps(v, vthr, _CMP_GE_OQ));
+        // Phần lớn anchor không vượt ngưỡng -> mask = 0, bỏ qua nhanh
+        while (mask) {
+            outIdx[count++] = i + lowestBit(mask);
+            mask &= mask - 1;
+        }
+    }
+#elif defined(__ARM_NEON)
+    const float32x4_t vthr = vdupq_n_f32(threshold);
+    for (; i + 4 <= n; i += 4) {
+        uint32x4_t m = vcgeq_f32(vld1q_f32(row + i), vthr);
+        uint32x2_t any = vorr_u32(vget_low_u32(m), vget_high_u32(m));
+        if ((vget_lane_u32(any, 0) | vget_lane_u32(any, 1)) == 0) continue;
+        if (vgetq_lane_u32(m, 0)) outIdx[count++] = i;
+        if (vgetq_lane_u32(m, 1)) outIdx[count++] = i + 1;
+        if (vgetq_lane_u32(m, 2)) outIdx[count++] = i + 2;
+        if (vgetq_lane_u32(m, 3)) outIdx[count++] = i + 3;
+    }
+#endif
+
+    // Phần còn lại (hoặc toàn bộ khi không có SIMD)
+    for (; i < n; ++i) {
+        if (row[i] >= threshold) outIdx[count++] = i;
+    }
+    return count;
+}
+
+static inline float rectIoU(const cv::Rect& a, const cv::Rect& b) {
+    int inter = (a & b).area();
+    if (inter <= 0) return 0.0f;
+    return (float)inter / (float)(a.area() + b.area() - inter);
+}
+
+void YoloDecoder::nms(float nmsThreshold, std::vector<Detection>& out) {
+    int n = (int)boxes.size();
+    order.resize(n);
+    // Sau khi lọc chỉ còn vài candidate -> insertion sort (ổn định, không cấp phát) theo score giảm dần,
+    // cùng score thì anchor đứng trước được ưu tiên như cv::dnn::NMSBoxes
+    for (int i = 0; i < n; ++i) {
+        int j = i;
+        while (j > 0 && scores[order[j - 1]] < scores[i]) {
+            order[j] = order[j - 1];
+            --j;
+        }
+        order[j] = i;
+    }
+
+    for (int idx : order) {
+        bool keep = true;
+        for (const auto& kept : out) {
+            if (rectIoU(boxes[idx], kept.box) > nmsThreshold) {
+                keep = false;
+                break;
+            }
+        }
+        if (keep) {
+            Detection det;
+            det.class_id = 0;
+            det.confidence = scores[idx];
+            det.box = boxes[idx];
+            out.push_back(det);
+        }
+    }
+}
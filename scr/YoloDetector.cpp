@@ -1,86 +1,476 @@
 #include "YoloDetector.h"
 #include "Config.h"
+#include "YoloDecoder.h"
+#include "StageMetrics.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <mutex>
+
+namespace {
+    // Precision mặc định cho YoloDetector(modelPath), đặt 1 lần trước khi tạo các luồng
+    Precision g_defaultPrecision = Precision::FP32;
+    std::string g_defaultCalibrationDir = Config::CALIBRATION_DIR;
+
+    // Blob calibration INT8 đã preprocess, theo thư mục: đọc + preprocess 1 lần cho cả process thay vì ở mỗi
+    // YoloDetector (Pipeline, ModelPool, segment worker tạo nhiều detector cùng lúc). Chỉ đọc sau khi dựng.
+    std::mutex g_calibrationMutex;
+    std::map<std::string, std::vector<cv::Mat>> g_calibrationSets;
+
+    // Bảng nội suy bilinear của preprocessInto cho 1 cặp (kích thước nguồn, inputSize),
+    // cùng quy ước tâm pixel với cv::resize INTER_LINEAR. Dựng lại chỉ khi kích thước đổi.
+    struct ResizePlan {
+        cv::Size src;
+        cv::Rect dst;
+        std::vector<int> x0, x1, y0, y1; // x tính theo byte (đã nhân 3 kênh)
+        std::vector<float> fx, fy;
+    };
+
+    void buildAxis(int src, int dst, std::vector<int>& i0, std::vector<int>& i1, std::vector<float>& w, int stride) {
+        i0.resize(dst);
+        i1.resize(dst);
+        w.resize(dst);
+        double scale = (double)src / dst;
+        for (int d = 0; d < dst; ++d) {
+            double s = (d + 0.5) * scale - 0.5;
+            int k = (int)std::floor(s);
+            float f = (float)(s - k);
+            if (k < 0) { k = 0; f = 0.0f; }
+            if (k >= src - 1) { k = src - 1; f = 0.0f; }
+            i0[d] = k * stride;
+            i1[d] = std::min(k + 1, src - 1) * stride;
+            w[d] = f;
+        }
+    }
+}
 
 YoloDetector::YoloDetector(const std::string& modelPath) {
+    load(modelPath, g_defaultPrecision, g_defaultCalibrationDir);
+}
+
+YoloDetector::YoloDetector(const std::string& modelPath, Precision precision, const std::string& calibrationDir) {
+    load(modelPath, precision, calibrationDir);
+}
+
+void YoloDetector::setDefaultPrecision(Precision precision, const std::string& calibrationDir) {
+    g_defaultPrecision = precision;
+    g_defaultCalibrationDir = calibrationDir;
+}
+
+bool YoloDetector::parsePrecision(const std::string& name, Precision& out) {
+    if (name == "fp32") out = Precision::FP32;
+    else if (name == "fp16") out = Precision::FP16;
+    else if (name == "int8") out = Precision::INT8;
+    else return false;
+    return true;
+}
+
+const char* YoloDetector::precisionName(Precision precision) {
+    switch (precision) {
+        case Precision::FP16: return "fp16";
+        case Precision::INT8: return "int8";
+        default: return "fp32";
+    }
+}
+
+bool YoloDetector::fp16Supported() {
+    // DNN_TARGET_CPU_FP16 có từ OpenCV 4.9 và chỉ nhanh hơn khi CPU tính FP16 trực tiếp (ARMv8.2 NEON FP16)
+#if (CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && CV_VERSION_MINOR >= 9)) && defined(CV_CPU_NEON_FP16)
+    return cv::checkHardwareSupport(CV_CPU_NEON_FP16);
+#else
+    return false;
+#endif
+}
+
+const std::vector<cv::Mat>& YoloDetector::calibrationSet(const std::string& calibrationDir) {
+    std::lock_guard<std::mutex> lock(g_calibrationMutex);
+    auto it = g_calibrationSets.find(calibrationDir);
+    if (it != g_calibrationSets.end()) return it->second;
+
+    std::vector<std::string> files;
+    cv::glob(calibrationDir + "/*.png", files, false);
+    if (files.size() > (size_t)Config::CALIBRATION_MAX_FRAMES) files.resize(Config::CALIBRATION_MAX_FRAMES);
+    std::vector<cv::Mat>& calibration = g_calibrationSets[calibrationDir];
+    for (const auto& file : files) {
+        cv::Mat image = cv::imread(file);
+        if (image.empty()) continue;
+        cv::Mat blob;
+        preprocess(image, blob, 640);
+        calibration.push_back(blob);
+    }
+    return calibration;
+}
+
+void YoloDetector::load(const std::string& modelPath, Precision precision, const std::string& calibrationDir) {
     net = cv::dnn::readNetFromONNX(modelPath);
     // Dùng CUDA nếu có
     // net.setPreferableBackend(cv::dnn::DNN_BACKEND_CUDA);
     // net.setPreferableTarget(cv::dnn::DNN_TARGET_CUDA);
+    activePrecision = Precision::FP32;
+
+    if (precision == Precision::FP16) {
+        if (!fp16Supported()) {
+            std::cerr << "FP16 inference not supported on this CPU, using FP32" << std::endl;
+            return;
+        }
+#if CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && CV_VERSION_MINOR >= 9)
+        net.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
+        net.setPreferableTarget(cv::dnn::DNN_TARGET_CPU_FP16);
+        activePrecision = Precision::FP16;
+#endif
+        return;
+    }
+
+    if (precision == Precision::INT8) {
+#if CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && CV_VERSION_MINOR >= 6)
+        // Bảng lượng tử (scale / zero point từng layer) được tính lại từ frame calibration cho mỗi net, vì
+        // cv::dnn không lưu hay sao chép được net đã lượng tử (copy Net dùng chung 1 impl, không forward song
+        // song được); frame calibration thì chỉ đọc 1 lần. Input / output vẫn float nên preprocess và decode
+        // giữ nguyên.
+        const std::vector<cv::Mat>& calibration = calibrationSet(calibrationDir);
+        if (calibration.empty()) {
+            std::cerr << "No calibration frames in " << calibrationDir
+                      << " (run PickleballCalibrate), using FP32" << std::endl;
+            return;
+        }
+        try {
+            net = net.quantize(calibration, CV_32F, CV_32F);
+            activePrecision = Precision::INT8;
+            batchSupported = false; // Net lượng tử được calibrate với batch 1
+        } catch (const cv::Exception& e) {
+            std::cerr << "INT8 quantization failed, using FP32: " << e.what() << std::endl;
+            net = cv::dnn::readNetFromONNX(modelPath);
+        }
+#else
+        (void)calibrationDir;
+        std::cerr << "INT8 inference needs OpenCV >= 4.6, using FP32" << std::endl;
+#endif
+    }
 }
 
 std::vector<Detection> YoloDetector::detect(cv::Mat& frame) {
     std::vector<Detection> detections;
-    
-    cv::Mat blob;
+    detect(frame, detections);
+    return detections;
+}
+
+void YoloDetector::detect(const cv::Mat& frame, std::vector<Detection>& out) {
     // YOLOv8 thường dùng 640x640, scale 1/255
-    cv::dnn::blobFromImage(frame, blob, 1.0/255.0, cv::Size(640, 640), cv::Scalar(), true, false);
+    preprocess(frame, blob, 640);
+    cv::Mat output = forward(blob);
+    decode(output, cv::Rect(0, 0, frame.cols, frame.rows), 640, out);
+}
+
+void YoloDetector::preprocess(const cv::Mat& image, cv::Mat& blob, int inputSize) {
+    METRICS_SCOPE(PREPROCESS);
+    // create() giữ buffer cũ khi blob đã đúng kích thước
+    int shape[4] = {1, 3, inputSize, inputSize};
+    blob.create(4, shape, CV_32F);
+    preprocessInto(image, blob.ptr<float>(), inputSize, cv::Rect(0, 0, inputSize, inputSize));
+}
+
+cv::Rect YoloDetector::letterboxRect(cv::Size image, int inputSize) {
+    double scale = std::min((double)inputSize / image.width, (double)inputSize / image.height);
+    int w = std::max(1, std::min(inputSize, (int)std::lround(image.width * scale)));
+    int h = std::max(1, std::min(inputSize, (int)std::lround(image.height * scale)));
+    return cv::Rect((inputSize - w) / 2, (inputSize - h) / 2, w, h);
+}
+
+void YoloDetector::preprocessInto(const cv::Mat& image, float* dst, int inputSize, const cv::Rect& placement) {
+    if (image.type() != CV_8UC3) {
+        // Ảnh gray / BGRA / không phải 8 bit: đổi về BGR 8 bit (có cấp phát, không nằm trên đường video thường)
+        cv::Mat bgr;
+        if (image.channels() == 1) cv::cvtColor(image, bgr, cv::COLOR_GRAY2BGR);
+        else if (image.channels() == 4) cv::cvtColor(image, bgr, cv::COLOR_BGRA2BGR);
+        else bgr = image;
+        if (bgr.depth() != CV_8U) bgr.convertTo(bgr, CV_8U);
+        preprocessInto(bgr, dst, inputSize, placement);
+        return;
+    }
+
+    thread_local ResizePlan plan;
+    if (plan.src != image.size() || plan.dst != placement) {
+        buildAxis(image.cols, placement.width, plan.x0, plan.x1, plan.fx, 3);
+        buildAxis(image.rows, placement.height, plan.y0, plan.y1, plan.fy, 1);
+        plan.src = image.size();
+        plan.dst = placement;
+    }
+
+    // 1 lượt thay cho resize + convertTo + split của blobFromImage: ghi thẳng plane R, G, B
+    const size_t plane = (size_t)inputSize * inputSize;
+    float* outR = dst;
+    float* outG = dst + plane;
+    float* outB = dst + 2 * plane;
+    const float scale = 1.0f / 255.0f;
+    const int* x0 = plan.x0.data();
+    const int* x1 = plan.x1.data();
+    const float* fx = plan.fx.data();
+
+    // Letterbox: phần ngoài placement tô xám 114 như lúc train YOLOv8
+    const float pad = 114.0f * scale;
+    const bool letterboxed = placement != cv::Rect(0, 0, inputSize, inputSize);
+    if (letterboxed) {
+        std::fill(dst, dst + 3 * plane, pad);
+    }
+
+    for (int py = 0; py < placement.height; ++py) {
+        const uint8_t* top = image.ptr<uint8_t>(plan.y0[py]);
+        const uint8_t* bottom = image.ptr<uint8_t>(plan.y1[py]);
+        const float wy = plan.fy[py];
+        const size_t row = (size_t)(placement.y + py) * inputSize + placement.x;
+        for (int x = 0; x < placement.width; ++x) {
+            const uint8_t* a = top + x0[x];
+            const uint8_t* b = top + x1[x];
+            const uint8_t* c = bottom + x0[x];
+            const uint8_t* d = bottom + x1[x];
+            const float wx = fx[x];
+            float v[3];
+            for (int ch = 0; ch < 3; ++ch) {
+                float t = a[ch] + wx * (b[ch] - a[ch]);
+                float u = c[ch] + wx * (d[ch] - c[ch]);
+                v[ch] = (t + wy * (u - t)) * scale;
+            }
+            outB[row + x] = v[0];
+            outG[row + x] = v[1];
+            outR[row + x] = v[2];
+        }
+    }
+}
+
+cv::Mat YoloDetector::forward(const cv::Mat& blob) {
+    METRICS_SCOPE(FORWARD);
+    if (outNames.empty()) outNames = net.getUnconnectedOutLayersNames();
     net.setInput(blob);
-    
-    std::vector<cv::Mat> outputs;
-    net.forward(outputs, net.getUnconnectedOutLayersNames());
-    
+    // outputs giữ buffer giữa các lần forward, trả về header (không copy)
+    net.forward(outputs, outNames);
+    return outputs[0];
+}
+
+std::vector<Detection> YoloDetector::decode(const cv::Mat& output, const cv::Rect& region, int inputSize) {
+    std::vector<Detection> detections;
+    decode(output, region, inputSize, detections);
+    return detections;
+}
+
+void YoloDetector::decode(const cv::Mat& output, const cv::Rect& region, int inputSize, std::vector<Detection>& out) {
     // Xử lý output (giả định YOLOv8: 1 x 84 x 8400)
     // 84 = 4 box coords + 80 classes (hoặc ít hơn tùy model custom)
     // Ở đây model custom có thể chỉ có 2 class (ball, line) -> 6 channels
-    
-    cv::Mat output = outputs[0]; // Shape: [1, channels, anchors]
-    // Transpose để dễ xử lý: [1, anchors, channels]
-    cv::Mat data = output.reshape(1, output.size[1]); // reshape(channels, rows)
-    data = data.t(); // Transpose
-    
-    float* pdata = (float*)data.data;
-    int rows = data.rows; 
-    int dimensions = data.cols; // x, y, w, h, score_class1, ...
-
-    std::vector<int> class_ids;
-    std::vector<float> confidences;
-    std::vector<cv::Rect> boxes;
-    
-    float x_factor = (float)frame.cols / 640.0;
-    float y_factor = (float)frame.rows / 640.0;
-
-    for (int i = 0; i < rows; ++i) {
-        float* row_ptr = data.ptr<float>(i);
-        
-        // Tìm class score cao nhất
-        float max_score = 0.0;
-        int class_id = -1;
-        // Bắt đầu từ index 4 (0,1,2,3 là bbox)
-        for(int j = 4; j < dimensions; ++j) {
-            if (row_ptr[j] > max_score) {
-                max_score = row_ptr[j];
-                class_id = j - 4;
-            }
+    // Shape: [1, channels, anchors]
+    decodeOutput(output.ptr<float>(), output.size[1], output.size[2], region, cv::Rect(0, 0, inputSize, inputSize), out);
+}
+
+std::vector<std::vector<Detection>> YoloDetector::detectBatch(const std::vector<cv::Mat>& frames) {
+    std::vector<std::vector<Detection>> results;
+    detectBatch(frames, results);
+    return results;
+}
+
+void YoloDetector::detectBatch(const std::vector<cv::Mat>& frames, std::vector<std::vector<Detection>>& results) {
+    // resize() giữ capacity của các vector con còn lại
+    results.resize(frames.size());
+    if (frames.empty()) return;
+
+    // Model export với batch cố định = 1 sẽ không forward được batch N -> chạy từng frame
+    if (frames.size() == 1 || !batchSupported) {
+        for (size_t n = 0; n < frames.size(); ++n) detect(frames[n], results[n]);
+        return;
+    }
+
+    // 1 blob N x 3 x 640 x 640, 1 lần forward
+    const int inputSize = 640;
+    const size_t frameFloats = (size_t)3 * inputSize * inputSize;
+    const size_t n = frames.size();
+    cv::Mat& input = batchBlob(n);
+    {
+        METRICS_SCOPE(PREPROCESS);
+        for (size_t i = 0; i < n; ++i) {
+            preprocessInto(frames[i], batchStorage.data() + i * frameFloats, inputSize,
+                           cv::Rect(0, 0, inputSize, inputSize));
         }
-        
-        if (max_score >= Config::CONF_THRESHOLD) {
-            // Chỉ lấy class Ball (giả sử Ball ID = 0)
-            if (class_id == 0) { 
-                float cx = row_ptr[0] * x_factor;
-                float cy = row_ptr[1] * y_factor;
-                float w = row_ptr[2] * x_factor;
-                float h = row_ptr[3] * y_factor;
-                
-                int left = int(cx - w / 2);
-                int top = int(cy - h / 2);
-                
-                boxes.push_back(cv::Rect(left, top, int(w), int(h)));
-                confidences.push_back(max_score);
-                class_ids.push_back(class_id);
+    }
+
+    cv::Mat output;
+    try {
+        output = forward(input);
+    } catch (const cv::Exception& e) {
+        std::cerr << "Batch inference not supported by model, falling back to batch size 1: "
+                  << e.what() << std::endl;
+        batchSupported = false;
+        detectBatch(frames, results);
+        return;
+    }
+
+    // Output: [N, channels, anchors] -> tách từng frame (mỗi frame là 1 khối liên tục)
+    int channels = output.size[1];
+    int anchors = output.size[2];
+    const float* base = output.ptr<float>();
+    for (size_t i = 0; i < n; ++i) {
+        const float* frameData = base + i * (size_t)channels * anchors;
+        decodeOutput(frameData, channels, anchors, cv::Rect(0, 0, frames[i].cols, frames[i].rows),
+                     cv::Rect(0, 0, inputSize, inputSize), results[i]);
+    }
+}
+
+cv::Mat& YoloDetector::batchBlob(size_t n) {
+    // Header cho từng N được dựng 1 lần, trỏ vào batchStorage
+    // (chỉ cấp phát lại khi gặp batch lớn hơn mọi batch trước)
+    const int inputSize = 640;
+    const size_t frameFloats = (size_t)3 * inputSize * inputSize;
+    if (batchStorage.size() < n * frameFloats) {
+        batchStorage.resize(n * frameFloats);
+        batchHeaders.clear();
+    }
+    if (batchHeaders.size() <= n) batchHeaders.resize(n + 1);
+    if (batchHeaders[n].empty()) {
+        int shape[4] = {(int)n, 3, inputSize, inputSize};
+        batchHeaders[n] = cv::Mat(4, shape, CV_32F, batchStorage.data());
+    }
+    return batchHeaders[n];
+}
+
+void YoloDetector::detectTiles(const cv::Mat& frame, const std::vector<cv::Rect>& tiles, std::vector<Detection>& out) {
+    out.clear();
+    const int inputSize = 640;
+    const size_t frameFloats = (size_t)3 * inputSize * inputSize;
+    const cv::Rect bounds(0, 0, frame.cols, frame.rows);
+    const size_t n = tiles.size();
+    if (tileResults.size() < n) tileResults.resize(n);
+
+    if (n > 1 && batchSupported) {
+        cv::Mat& input = batchBlob(n);
+        float* base = batchStorage.data();
+        {
+            METRICS_SCOPE(PREPROCESS);
+            // Các tile độc lập nhau -> chia cho các core (bảng resize là thread_local)
+            cv::parallel_for_(cv::Range(0, (int)n), [&](const cv::Range& range) {
+                for (int i = range.start; i < range.end; ++i) {
+                    cv::Rect crop = tiles[i] & bounds;
+                    float* dst = base + i * frameFloats;
+                    if (crop.area() <= 0) {
+                        std::fill(dst, dst + frameFloats, 0.0f);
+                        continue;
+                    }
+                    preprocessInto(frame(crop), dst, inputSize, letterboxRect(crop.size(), inputSize));
+                }
+            });
+        }
+
+        cv::Mat output;
+        try {
+            output = forward(input);
+        } catch (const cv::Exception& e) {
+            std::cerr << "Batch inference not supported by model, tiles run one by one: " << e.what() << std::endl;
+            batchSupported = false;
+            detectTiles(frame, tiles, out);
+            return;
+        }
+
+        int channels = output.size[1];
+        int anchors = output.size[2];
+        const float* data = output.ptr<float>();
+        for (size_t i = 0; i < n; ++i) {
+            cv::Rect crop = tiles[i] & bounds;
+            tileResults[i].clear();
+            if (crop.area() <= 0) continue;
+            decodeOutput(data + i * (size_t)channels * anchors, channels, anchors, crop,
+                         letterboxRect(crop.size(), inputSize), tileResults[i]);
+        }
+    } else {
+        int shape[4] = {1, 3, inputSize, inputSize};
+        for (size_t i = 0; i < n; ++i) {
+            cv::Rect crop = tiles[i] & bounds;
+            tileResults[i].clear();
+            if (crop.area() <= 0) continue;
+            cv::Rect placement = letterboxRect(crop.size(), inputSize);
+            {
+                METRICS_SCOPE(PREPROCESS);
+                blob.create(4, shape, CV_32F);
+                preprocessInto(frame(crop), blob.ptr<float>(), inputSize, placement);
             }
+            cv::Mat output = forward(blob);
+            decodeOutput(output.ptr<float>(), output.size[1], output.size[2], crop, placement, tileResults[i]);
         }
     }
-    
-    std::vector<int> indices;
-    cv::dnn::NMSBoxes(boxes, confidences, Config::SCORE_THRESHOLD, Config::NMS_THRESHOLD, indices);
-    
-    for (int idx : indices) {
-        Detection det;
-        det.class_id = class_ids[idx];
-        det.confidence = confidences[idx];
-        det.box = boxes[idx];
-        detections.push_back(det);
-    }
-    
+
+    for (size_t i = 0; i < n; ++i) out.insert(out.end(), tileResults[i].begin(), tileResults[i].end());
+    mergeTiles(out);
+}
+
+void YoloDetector::mergeTiles(std::vector<Detection>& detections) {
+    METRICS_SCOPE(POSTPROCESS);
+    std::sort(detections.begin(), detections.end(),
+              [](const Detection& a, const Detection& b) { return a.confidence > b.confidence; });
+
+    // NMS tham lam tại chỗ: giữ box đứng trước nếu chồng lên box đã giữ
+    size_t kept = 0;
+    for (size_t i = 0; i < detections.size(); ++i) {
+        const cv::Rect& box = detections[i].box;
+        bool keep = true;
+        for (size_t j = 0; j < kept && keep; ++j) {
+            if (detections[j].class_id != detections[i].class_id) continue;
+            const cv::Rect& other = detections[j].box;
+            float inter = (float)(box & other).area();
+            if (inter <= 0.0f) continue;
+            float iou = inter / (float)(box.area() + other.area() - inter);
+            // Box bị mép tile cắt nằm gọn trong box đầy đủ của tile kề -> IoU thấp nhưng tỉ lệ giao / box nhỏ cao
+            float overlapSmall = inter / (float)std::max(1, std::min(box.area(), other.area()));
+            if (iou > Config::NMS_THRESHOLD || overlapSmall > Config::TILE_MERGE_OVERLAP) keep = false;
+        }
+        if (keep) detections[kept++] = detections[i];
+    }
+    detections.resize(kept);
+}
+
+std::vector<Detection> YoloDetector::detectRoi(const cv::Mat& frame, const cv::Rect& roi, int inputSize) {
+    std::vector<Detection> detections;
+    detectRoi(frame, roi, inputSize, detections);
     return detections;
-}
\ No newline at end of file
+}
+
+void YoloDetector::detectRoi(const cv::Mat& frame, const cv::Rect& roi, int inputSize, std::vector<Detection>& out) {
+    out.clear();
+    cv::Rect crop = roi & cv::Rect(0, 0, frame.cols, frame.rows);
+    if (crop.width <= 0 || crop.height <= 0) return;
+    if (!dynamicInputSupported) inputSize = 640;
+
+    preprocess(frame(crop), blob, inputSize);
+
+    cv::Mat output;
+    try {
+        output = forward(blob);
+    } catch (const cv::Exception& e) {
+        // Model export với input cố định 640x640 -> crop vẫn được phóng lên 640
+        if (inputSize == 640) throw;
+        std::cerr << "Dynamic input size not supported by model, ROI crops use 640x640: "
+                  << e.what() << std::endl;
+        dynamicInputSupported = false;
+        detectRoi(frame, roi, 640, out);
+        return;
+    }
+
+    decode(output, crop, inputSize, out);
+}
+
+void YoloDetector::decodeOutput(const float* output, int channels, int anchors, const cv::Rect& region,
+                                const cv::Rect& placement, std::vector<Detection>& out) {
+    METRICS_SCOPE(POSTPROCESS);
+    DecodeParams params;
+    params.confThreshold = Config::CONF_THRESHOLD;
+    params.scoreThreshold = Config::SCORE_THRESHOLD;
+    params.nmsThreshold = Config::NMS_THRESHOLD;
+    // frame = (net - placement.tl) * region / placement + region.tl
+    params.scaleX = (float)region.width / placement.width;
+    params.scaleY = (float)region.height / placement.height;
+    params.offsetX = (float)region.x - placement.x * params.scaleX;
+    params.offsetY = (float)region.y - placement.y * params.scaleY;
+
+    // Đọc trực tiếp tensor [channels, anchors], không transpose. decoder ghi đè out, giữ capacity.
+    int numClasses = channels - 4;
+    if (numClasses == Config::NUM_CLASSES) {
+        decoder.decode<Config::NUM_CLASSES>(output, anchors, params, out);
+    } else {
+        decoder.decode(output, numClasses, anchors, params, out);
+    }
+}
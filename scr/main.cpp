@@ -1,14 +1,229 @@
 #include <opencv2/opencv.hpp>
 #include <iostream>
+#include <string>
+#include <cstdlib>
+#include <memory>
 #include "Config.h"
 #include "YoloDetector.h"
 #include "BallTracker.h"
 #include "LineDetector.h"
+#include "Pipeline.h"
+#include "RoiScheduler.h"
+#include "LinePicker.h"
+#include "CadenceScheduler.h"
+#include "MotionGate.h"
+#include "CourtModel.h"
+#include <sstream>
+#include "Renderer.h"
+#include "EventWriter.h"
+#include "StageMetrics.h"
+#include "StreamServer.h"
+#include "SegmentedRunner.h"
+#include "ClipRecorder.h"
+#include "DetectionTrace.h"
+#include "AnalysisSession.h"
+#include "LiveCapture.h"
+#include "LiveRunner.h"
+#include <chrono>
+#include <csignal>
 
-int main() {
-    // 1. Setup
-    // cv::VideoCapture cap(0); // Camera input (uncomment when needed)
-    cv::VideoCapture cap(Config::SOURCE_VIDEO_PATH);
+// "x1,y1,x2,y2,x3,y3,x4,y4" -> 4 góc sân (gần-trái, gần-phải, xa-phải, xa-trái)
+static bool parseCorners(const std::string& text, std::vector<cv::Point2f>& corners) {
+    std::stringstream ss(text);
+    std::string item;
+    std::vector<float> values;
+    while (std::getline(ss, item, ',')) {
+        try {
+            values.push_back(std::stof(item));
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+    if (values.size() != 8) return false;
+    corners.clear();
+    for (int i = 0; i < 4; ++i) corners.emplace_back(values[2 * i], values[2 * i + 1]);
+    return true;
+}
+
+// "Out.mp4" + 2 -> "Out_2.mp4"
+static std::string indexedPath(const std::string& path, size_t index) {
+    if (path.empty()) return path;
+    size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos) return path + "_" + std::to_string(index);
+    return path.substr(0, dot) + "_" + std::to_string(index) + path.substr(dot);
+}
+
+// Ctrl+C ở live mode: dừng vòng xử lý để vẫn in thống kê và đóng file
+static LiveRunner* g_liveRunner = nullptr;
+static void onInterrupt(int) {
+    if (g_liveRunner) g_liveRunner->requestStop();
+}
+
+int main(int argc, char** argv) {
+    // Headless: chỉ phân tích + xuất event, không vẽ overlay và không encode video
+    bool headless = Config::HEADLESS;
+    bool adaptive = Config::ADAPTIVE_CADENCE;
+    bool roiDetection = Config::ROI_DETECTION;
+    bool motionGate = Config::MOTION_GATE;
+    bool lineTracking = Config::LINE_TRACKING;
+    bool courtMode = Config::COURT_MODEL;
+    bool clips = Config::CLIP_RECORDING;
+    bool tiled = Config::TILED_INFERENCE;
+    std::vector<cv::Point2f> courtCorners;
+    std::vector<std::string> streamSources;
+    int segmentWorkers = 0;
+    std::string precisionName = Config::INFERENCE_PRECISION;
+    std::string sourcePath = Config::SOURCE_VIDEO_PATH;
+    std::string tracePath = Config::TRACE_PATH;
+    std::string replayPath;
+    std::string liveSource;
+    double liveDeadlineMs = Config::LIVE_DEADLINE_MS;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--headless") headless = true;
+        else if (arg == "--adaptive") adaptive = true;
+        else if (arg == "--roi") roiDetection = true;
+        else if (arg == "--motion-gate") motionGate = true;
+        else if (arg == "--track-lines") lineTracking = true;
+        else if (arg == "--court") courtMode = true;
+        else if (arg == "--clips") clips = true;
+        else if (arg == "--tiled") tiled = true;
+        else if (arg == "--court-corners" && i + 1 < argc) {
+            if (!parseCorners(argv[++i], courtCorners)) {
+                std::cerr << "--court-corners expects x1,y1,x2,y2,x3,y3,x4,y4" << std::endl;
+                return -1;
+            }
+            courtMode = true;
+        }
+        else if (arg == "--stream" && i + 1 < argc) streamSources.push_back(argv[++i]);
+        else if (arg == "--segments" && i + 1 < argc) segmentWorkers = std::atoi(argv[++i]);
+        else if (arg == "--precision" && i + 1 < argc) precisionName = argv[++i];
+        else if (arg == "--source" && i + 1 < argc) sourcePath = argv[++i];
+        else if (arg == "--record-trace" && i + 1 < argc) tracePath = argv[++i];
+        else if (arg == "--replay" && i + 1 < argc) replayPath = argv[++i];
+        else if (arg == "--live" && i + 1 < argc) liveSource = argv[++i];
+        else if (arg == "--deadline-ms" && i + 1 < argc) liveDeadlineMs = std::atof(argv[++i]);
+    }
+
+    // Replay: chạy lại tracker + bounce từ trace đã ghi, không mở video, không load model
+    if (!replayPath.empty()) {
+        TraceReader trace;
+        if (!trace.open(replayPath)) {
+            std::cerr << "Cannot open trace " << replayPath << std::endl;
+            return -1;
+        }
+        std::string replayEventsPath = DetectionTrace::eventsPathFor(replayPath);
+        EventWriter events(replayEventsPath);
+        auto start = std::chrono::steady_clock::now();
+        long total = DetectionTrace::replay(trace, [&](long frameIndex, double timestampMs, const TrackResult& result) {
+            events.write(frameIndex, timestampMs, result);
+        });
+        double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "Replayed " << total << " frames in " << sec << " s ("
+                  << (sec > 0.0 ? total / sec : 0.0) << " fps)" << std::endl;
+        std::cout << "Wrote " << events.written() << " events to " << replayEventsPath << std::endl;
+        return 0;
+    }
+
+    // Mọi detector tạo sau đây (Pipeline, server, segment worker) dùng precision này
+    Precision precision;
+    if (!YoloDetector::parsePrecision(precisionName, precision)) {
+        std::cerr << "--precision expects fp32, fp16 or int8" << std::endl;
+        return -1;
+    }
+    YoloDetector::setDefaultPrecision(precision, Config::CALIBRATION_DIR);
+
+    // Server mode: nhiều sân trong 1 process, dùng chung pool detector
+    if (!streamSources.empty()) {
+        std::vector<StreamSource> sources;
+        for (size_t i = 0; i < streamSources.size(); ++i) {
+            StreamSource s;
+            s.source = streamSources[i];
+            s.outputPath = headless ? "" : indexedPath(Config::TARGET_VIDEO_PATH, i);
+            s.eventsPath = indexedPath(Config::EVENTS_PATH, i);
+            sources.push_back(s);
+        }
+        StreamServer server(Config::MODEL_PATH, Config::SERVER_DETECT_WORKERS, Config::SERVER_MAX_BATCH,
+                            Config::SERVER_LATENCY_BUDGET_MS, Config::QUEUE_CAPACITY);
+        server.setMotionGate(motionGate);
+        server.setLineTracking(lineTracking);
+        server.setCourtModel(courtMode);
+        long total = server.run(sources);
+        std::cout << "Processed " << total << " frames from " << sources.size() << " streams" << std::endl;
+        METRICS_REPORT_FINAL(std::cout, Config::METRICS_JSON_PATH, Config::METRICS_CSV_PATH);
+        return 0;
+    }
+
+    // Live mode: camera / stream, luôn xử lý frame mới nhất trong hạn deadline thay vì đọc hết mọi frame
+    if (!liveSource.empty()) {
+        LiveCapture capture;
+        if (!capture.open(liveSource)) {
+            std::cerr << "Cannot open live source " << liveSource << std::endl;
+            return -1;
+        }
+        capture.start();
+        cv::Mat firstFrame;
+        LiveCapture::Clock::time_point capturedAt;
+        long sequence = 0;
+        if (!capture.latest(firstFrame, capturedAt, sequence)) {
+            std::cerr << "No frame from live source" << std::endl;
+            return -1;
+        }
+
+        LineDetector lineDetector;
+        CourtLine selectedLine;
+        bool lineFound = headless ? lineDetector.getLongestLine(firstFrame, selectedLine)
+                                  : LinePicker::selectLine(lineDetector, firstFrame, selectedLine);
+        if (lineFound) {
+            std::cout << "Line selected: " << selectedLine.pt1 << " -> " << selectedLine.pt2 << std::endl;
+        } else {
+            std::cerr << "No court line found!" << std::endl;
+        }
+
+        // Mô hình sân + line tracking chạy trong session của runner, calibrate từ frame live đầu tiên
+        SessionOptions options;
+        options.hasCourtLine = lineFound;
+        options.courtLine = selectedLine;
+        options.autoCourtLine = false;
+        options.courtModel = courtMode;
+        options.courtCorners = courtCorners;
+        options.lineTracking = lineTracking;
+        options.tiled = false;
+        LiveRunner runner(Config::MODEL_PATH, liveDeadlineMs, options);
+        cv::VideoWriter writer;
+        if (!headless) {
+            writer.open(Config::TARGET_VIDEO_PATH, cv::VideoWriter::fourcc('m','p','4','v'),
+                        capture.fps() > 0.0 ? capture.fps() : 30, firstFrame.size());
+        }
+        EventWriter events(Config::EVENTS_PATH);
+
+        g_liveRunner = &runner;
+        std::signal(SIGINT, onInterrupt);
+        std::cout << "Live: " << liveSource << ", deadline " << liveDeadlineMs << " ms (Ctrl+C to stop)" << std::endl;
+        long total = runner.run(capture, events, &writer);
+        std::signal(SIGINT, SIG_DFL);
+        g_liveRunner = nullptr;
+        capture.stop();
+
+        std::cout << "Processed " << total << " of " << capture.captured() << " captured frames ("
+                  << capture.dropped() << " dropped for newer ones)" << std::endl;
+        std::cout << "Latency capture -> decision: mean " << runner.meanLatencyMs() << " ms, max "
+                  << runner.maxLatencyMs() << " ms, " << runner.deadlineMisses() << " deadline misses, "
+                  << runner.degradations() << " degradations, ended at " << LiveRunner::levelName(runner.level())
+                  << std::endl;
+        if (!runner.bounceLatencies().empty()) {
+            std::cout << "Bounce calls: " << runner.bounceLatencies().size() << ", latency p50 "
+                      << runner.bounceLatencyPercentile(0.5) << " ms, p95 "
+                      << runner.bounceLatencyPercentile(0.95) << " ms" << std::endl;
+        }
+        METRICS_REPORT_FINAL(std::cout, Config::METRICS_JSON_PATH, Config::METRICS_CSV_PATH);
+        std::cout << "Wrote " << events.written() << " events to " << Config::EVENTS_PATH << std::endl;
+        if (writer.isOpened()) writer.release();
+        return 0;
+    }
+
+    // 1. Setup (file; camera / stream dùng --live)
+    cv::VideoCapture cap(sourcePath);
     if (!cap.isOpened()) {
         std::cerr << "Cannot open video" << std::endl;
         return -1;
@@ -16,19 +231,30 @@ int main() {
 
     int width = cap.get(cv::CAP_PROP_FRAME_WIDTH);
     int height = cap.get(cv::CAP_PROP_FRAME_HEIGHT);
-    cv::VideoWriter writer(Config::TARGET_VIDEO_PATH, cv::VideoWriter::fourcc('m','p','4','v'), 
-                           30, cv::Size(width, height));
+    cv::VideoWriter writer;
+    if (!headless && !clips && segmentWorkers == 0) {
+        writer.open(Config::TARGET_VIDEO_PATH, cv::VideoWriter::fourcc('m','p','4','v'), 
+                    30, cv::Size(width, height));
+    }
+    // Highlight clip: chỉ encode quanh bounce, trên luồng nền
+    std::unique_ptr<ClipRecorder> recorder;
+    if (clips && segmentWorkers == 0) {
+        recorder.reset(new ClipRecorder(Config::CLIP_DIR, cap.get(cv::CAP_PROP_FPS), Config::CLIP_PRE_ROLL_FRAMES,
+                                        Config::CLIP_POST_ROLL_FRAMES, Config::CLIP_MAX_FRAMES,
+                                        Config::CLIP_MAX_PENDING));
+    }
+    EventWriter events(Config::EVENTS_PATH);
 
     // 2. Init Modules
-    YoloDetector detector(Config::MODEL_PATH);
-    BallTracker tracker;
     LineDetector lineDetector;
 
     // 3. Line Selection (Giả lập: Lấy line dài nhất frame đầu tiên)
     cv::Mat firstFrame;
     cap.read(firstFrame);
     CourtLine selectedLine;
-    bool lineFound = lineDetector.getMainLine(firstFrame, selectedLine);
+    // Headless không có cửa sổ để click -> chọn line dài nhất
+    bool lineFound = (headless || segmentWorkers > 0) ? lineDetector.getLongestLine(firstFrame, selectedLine)
+                              : LinePicker::selectLine(lineDetector, firstFrame, selectedLine);
     
     // Định nghĩa điểm OUT mẫu (giả sử bên phải line là OUT cho demo)
     // Trong thực tế, bạn cần thuật toán xác định phía hoặc UI click chuột
@@ -40,44 +266,197 @@ int main() {
         std::cerr << "No court line found!" << std::endl;
     }
     
+    // Tracker, line tracking, mô hình sân (góc nhập tay hoặc fit từ các line của frame đầu) và tile
+    // nằm trong session; luồng track gọi session.track() cho từng frame như mọi mode khác
+    SessionOptions options;
+    options.hasCourtLine = lineFound;
+    options.courtLine = selectedLine;
+    options.autoCourtLine = false;
+    options.hasOutRefPoint = true;
+    options.outRefPoint = outRefPoint;
+    options.courtModel = courtMode;
+    options.courtCorners = courtCorners;
+    options.lineTracking = lineTracking;
+    options.tiled = tiled;
+    AnalysisSession session(options);
+    session.begin(firstFrame);
+    const CourtModel& court = session.court();
+    if (courtMode) {
+        if (court.valid()) {
+            std::cout << "Court calibrated: " << court.corners()[0] << " " << court.corners()[1] << " "
+                      << court.corners()[2] << " " << court.corners()[3] << std::endl;
+        } else {
+            std::cerr << "Court calibration failed, falling back to the selected line" << std::endl;
+        }
+    }
+
+    // Xử lý theo đoạn song song: mỗi worker tự mở file và có detector riêng, chỉ xuất event
+    if (segmentWorkers > 0) {
+        cap.release();
+        // Mọi đoạn dùng line và sân của frame đầu: sân đã fit được truyền dưới dạng 4 góc để không fit lại mỗi đoạn
+        SessionOptions segmentOptions = options;
+        if (court.valid()) segmentOptions.courtCorners = court.corners();
+        SegmentedRunner runner(Config::MODEL_PATH, segmentWorkers, Config::SEGMENT_OVERLAP_FRAMES, segmentOptions);
+        long total = runner.run(sourcePath, events);
+        if (total < 0) {
+            std::cerr << "Segmented mode needs a file with a known frame count" << std::endl;
+            return -1;
+        }
+        std::cout << "Processed " << total << " frames with " << segmentWorkers << " segment workers" << std::endl;
+        METRICS_REPORT_FINAL(std::cout, Config::METRICS_JSON_PATH, Config::METRICS_CSV_PATH);
+        std::cout << "Wrote " << events.written() << " events to " << Config::EVENTS_PATH << std::endl;
+        if (runner.failedSegments() > 0) {
+            std::cerr << runner.failedSegments() << " segments failed (inexact seek?), their frames have no events; "
+                      << "run without --segments for this file" << std::endl;
+            return -1;
+        }
+        return 0;
+    }
+
     cap.set(cv::CAP_PROP_POS_FRAMES, 0); // Reset video
 
-    // 4. Processing Loop
-    cv::Mat frame;
-    while (cap.read(frame)) {
-        // Detect Ball
-        auto detections = detector.detect(frame);
-        
-        // Convert Detection to cv::Rect for tracker
-        std::vector<cv::Rect> detectionBoxes;
-        for (const auto& det : detections) {
-            detectionBoxes.push_back(det.box);
-        }
-        
-        // Tracking & Logic
-        cv::Point2f ballCenter;
-        if (tracker.update(detectionBoxes, frame, ballCenter)) {
-            // Nếu có bóng và có line -> Check Bounce
-            if (lineFound) {
-                tracker.processBounce(frame, ballCenter, selectedLine.pt1, selectedLine.pt2, outRefPoint);
-            }
+    // Tiled inference: chỉ detect vùng sân, chia tile letterbox thay vì ép cả frame vào 640x640
+    // (vùng sân + tile do session tính từ frame đầu)
+    const std::vector<cv::Rect>& tiles = session.tiles();
+    if (tiled) {
+        if (tiles.empty()) {
+            std::cerr << "No court region for tiled inference, detecting on the full frame" << std::endl;
+        } else {
+            std::cout << "Tiled inference: " << tiles.size() << " tiles over the court region" << std::endl;
         }
-        
-        // Draw Line
-        if (lineFound) {
-            cv::line(frame, selectedLine.pt1, selectedLine.pt2, cv::Scalar(255, 0, 0), 3);
-            cv::circle(frame, outRefPoint, 5, cv::Scalar(0,0,255), -1);
-            cv::putText(frame, "OUT REF", outRefPoint, cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(0,0,255), 1);
+    }
+
+    // ROI / adaptive cadence detect tuần tự theo frame -> chỉ cần 1 detector
+    bool inOrderDetect = roiDetection || adaptive;
+    int detectWorkers = inOrderDetect ? 1 : Config::DETECT_WORKERS;
+    Pipeline pipeline(Config::MODEL_PATH, detectWorkers, Config::QUEUE_CAPACITY,
+                      Config::BATCH_SIZE, Config::BATCH_TIMEOUT_MS);
+    pipeline.setTiles(tiles);
+
+    RoiScheduler roiScheduler;
+    CadenceScheduler cadence;
+    if (lineFound) cadence.setCourtLine(selectedLine);
+
+    // Motion gate chạy trên luồng decode: frame tĩnh không tới detector
+    MotionGate gate;
+    if (motionGate) {
+        pipeline.setPreDetect([&](FramePacket& packet) {
+            packet.skipDetect = !gate.evaluate(packet.frame, packet.detectRegion, packet.detectInputSize);
+        });
+    }
+
+    // Trace detection cho replay: detection + thống kê màu + line biên từng frame, ghi trên luồng track
+    TraceWriter trace;
+    if (!tracePath.empty()) {
+        if (trace.open(tracePath, cv::Size(width, height), cap.get(cv::CAP_PROP_FPS), outRefPoint, &court)) {
+            std::cout << "Recording detection trace to " << tracePath << std::endl;
+        } else {
+            std::cerr << "Cannot write trace " << tracePath << std::endl;
+        }
+    }
+
+    // 4. Processing Loop (decode -> detect -> track -> encode chạy song song)
+    BallTracker& tracker = session.ballTracker();
+    auto trackStage = [&](FramePacket& packet) {
+        // Tracking, line tracking (+ calibrate lại sân) và IN/OUT: bước lõi chung với mọi mode
+        session.track(packet.frame, packet.index, packet.detections, packet.track);
+        if (session.courtLineChanged() && adaptive) cadence.setCourtLine(session.courtLine());
+        // Mỗi packet mang line của frame đó (overlay ở stage encode)
+        packet.hasCourtLine = session.hasCourtLine();
+        packet.courtLine = session.courtLine();
+
+        if (adaptive) cadence.observe(packet.frame, packet.index, packet.track);
+        if (trace.isOpen()) {
+            trace.write(packet.index, packet.timestampMs, packet.detections, tracker.detectionStats(),
+                        packet.hasCourtLine ? &packet.courtLine : nullptr);
         }
+    };
 
-        writer.write(frame);
-        
-        
+    // Overlay được vẽ ở stage encode, tách khỏi luồng tracking
+    auto encodeStage = [&](FramePacket& packet) {
+        {
+            METRICS_SCOPE(EVENTS);
+            events.write(packet.index, packet.timestampMs, packet.track);
+        }
+        if (!headless || recorder) {
+            {
+                METRICS_SCOPE(RENDER);
+                Renderer::drawTrack(packet.frame, packet.track);
+                if (packet.hasCourtLine) {
+                    Renderer::drawCourtLine(packet.frame, packet.courtLine, outRefPoint);
+                }
+            }
+            if (recorder) {
+                recorder->push(packet.frame, packet.index, packet.track.bounceDetected);
+            } else {
+                METRICS_SCOPE(WRITE);
+                writer.write(packet.frame);
+            }
+        }
+        METRICS_FRAME_DONE();
+        METRICS_REPORT_PERIODIC(std::cout, Config::METRICS_INTERVAL_S);
+    };
+
+    long frameCount = 0;
+    if (inOrderDetect) {
+        auto detectStage = [&](YoloDetector& detector, FramePacket& packet) {
+            if (packet.skipDetect) return;
+
+            // Adaptive: frame giữa 2 key frame chỉ bám bóng bằng template, không chạy YOLO
+            if (adaptive && cadence.trackOnly(packet.frame, packet.index, tracker, packet.detections)) return;
+
+            if (roiDetection) {
+                // Detect trên vùng Kalman dự đoán, refresh cả frame định kỳ
+                roiScheduler.detect(detector, packet.frame, packet.index, tracker, packet.detections);
+            } else if (packet.detectRegion.area() > 0) {
+                detector.detectRoi(packet.frame, packet.detectRegion, packet.detectInputSize, packet.detections);
+            } else if (!tiles.empty()) {
+                detector.detectTiles(packet.frame, tiles, packet.detections);
+            } else {
+                detector.detect(packet.frame, packet.detections);
+            }
+            if (adaptive) cadence.keyFrame(packet.index, packet.detections);
+        };
+        frameCount = pipeline.run(cap, detectStage, trackStage, encodeStage);
+        if (roiDetection) {
+            std::cout << "ROI detection: " << roiScheduler.roiFrames() << " crop / "
+                      << roiScheduler.fullFrames() << " full-frame passes" << std::endl;
+        }
+        if (adaptive) {
+            std::cout << "Adaptive cadence: " << cadence.keyFrames() << " detector / "
+                      << cadence.trackedFrames() << " tracking-only frames" << std::endl;
+        }
+    } else {
+        frameCount = pipeline.run(cap, trackStage, encodeStage);
+    }
+    std::cout << "Processed " << frameCount << " frames" << std::endl;
+    if (recorder) recorder->finish(); // Chờ clip cuối encode xong trước khi báo cáo
+    if (trace.isOpen()) {
+        trace.close();
+        std::cout << "Wrote " << trace.written() << " trace frames to " << tracePath << std::endl;
     }
+    if (session.lines().valid()) {
+        std::cout << "Line tracking: " << session.lines().refits() << " refits, "
+                  << session.lines().redetections() << " full re-detections ("
+                  << session.lines().failedRedetections() << " failed)" << std::endl;
+    }
+    if (motionGate) {
+        std::cout << "Motion gate: " << gate.skippedFrames() << " frames skipped, "
+                  << gate.regionFrames() << " detected on a motion region" << std::endl;
+    }
+    METRICS_REPORT_FINAL(std::cout, Config::METRICS_JSON_PATH, Config::METRICS_CSV_PATH);
 
     cap.release();
-    writer.release();
-    std::cout << "Done! Output saved to " << Config::TARGET_VIDEO_PATH << std::endl;
+    if (events.isOpen()) {
+        std::cout << "Wrote " << events.written() << " events to " << Config::EVENTS_PATH << std::endl;
+    }
+    if (recorder) {
+        std::cout << "Wrote " << recorder->clipsWritten() << " clips (" << recorder->framesWritten()
+                  << " frames) to " << Config::CLIP_DIR << std::endl;
+    } else if (!headless) {
+        writer.release();
+        std::cout << "Done! Output saved to " << Config::TARGET_VIDEO_PATH << std::endl;
+    }
 
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,165 @@
+// Test: đường đi 1 frame của pipeline thật (decode -> detect -> track -> events) không cấp phát heap
+// khi đã chạy ổn định. Video nguồn là SyntheticRally ghi ra file tạm; Pipeline::run tuần tự với detect
+// stage sinh detection từ ground truth + nhiễu + detection giả (như PickleballSynth --oracle) nên không cần
+// model, và trackStage gọi AnalysisSession::track như app. cv::dnn forward không nằm trong phép đo
+// (cấp phát bên trong forward ngoài tầm kiểm soát của project).
+// Sau ALLOC_WARMUP frame, mọi operator new của process (mọi luồng) và mọi buffer cv::Mat được đếm;
+// còn cấp phát -> mã lỗi 1.
+//
+//   ./PickleballAllocTest
+
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+#include "Config.h"
+#include "Pipeline.h"
+#include "AnalysisSession.h"
+#include "EventWriter.h"
+#include "Renderer.h"
+#include "SyntheticRally.h"
+
+// Mọi operator new và mọi buffer cv::Mat (qua MatAllocator mặc định) được đếm khi g_countAllocs bật;
+// ngoài khoảng đo chỉ là malloc / free bình thường.
+static std::atomic<bool> g_countAllocs{false};
+static std::atomic<long> g_heapAllocs{0};
+static std::atomic<long> g_matAllocs{0};
+
+void* operator new(std::size_t size) {
+    if (g_countAllocs.load(std::memory_order_relaxed)) g_heapAllocs.fetch_add(1, std::memory_order_relaxed);
+    void* p = std::malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+void* operator new[](std::size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+// cv::Mat cấp phát bằng fastMalloc, không qua operator new -> bọc allocator mặc định của OpenCV
+class CountingMatAllocator : public cv::MatAllocator {
+public:
+    explicit CountingMatAllocator(cv::MatAllocator* base) : base(base) {}
+    cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+                           cv::AccessFlag flags, cv::UMatUsageFlags usageFlags) const override {
+        if (g_countAllocs.load(std::memory_order_relaxed)) g_matAllocs.fetch_add(1, std::memory_order_relaxed);
+        return base->allocate(dims, sizes, type, data, step, flags, usageFlags);
+    }
+    bool allocate(cv::UMatData* data, cv::AccessFlag accessFlags, cv::UMatUsageFlags usageFlags) const override {
+        return base->allocate(data, accessFlags, usageFlags);
+    }
+    void deallocate(cv::UMatData* data) const override { base->deallocate(data); }
+
+private:
+    cv::MatAllocator* base;
+};
+
+static const long ALLOC_WARMUP = 100;   // Frame chạy trước khi bắt đầu đếm (pool packet, buffer detector đầy đủ)
+static const long ALLOC_MEASURED = 200; // Frame được đếm
+
+// Rally tổng hợp 720p đủ dài cho warmup + đo, ghi MJPG để decode nhẹ
+static bool writeSyntheticVideo(const std::string& path, SyntheticRally& synth) {
+    cv::VideoWriter writer(path, cv::VideoWriter::fourcc('M', 'J', 'P', 'G'), synth.options().fps,
+                           synth.options().frameSize);
+    if (!writer.isOpened()) return false;
+    cv::Mat frame;
+    for (long i = 0; i < synth.frames(); ++i) {
+        synth.render(i, frame);
+        writer.write(frame);
+    }
+    return true;
+}
+
+int main() {
+    SyntheticRally::Options synthOptions;
+    synthOptions.frameSize = cv::Size(1280, 720);
+    synthOptions.fps = 30.0;
+    synthOptions.seconds = (ALLOC_WARMUP + ALLOC_MEASURED + 30) / synthOptions.fps;
+    SyntheticRally synth(synthOptions);
+    std::string videoPath = cv::tempfile(".avi");
+    if (!writeSyntheticVideo(videoPath, synth)) {
+        std::printf("alloc-test FAILED: cannot write %s\n", videoPath.c_str());
+        return 1;
+    }
+
+    cv::VideoCapture cap(videoPath);
+    cv::Mat firstFrame;
+    if (!cap.isOpened() || !cap.read(firstFrame)) {
+        std::printf("alloc-test FAILED: cannot read %s\n", videoPath.c_str());
+        std::remove(videoPath.c_str());
+        return 1;
+    }
+    cap.set(cv::CAP_PROP_POS_FRAMES, 0);
+
+    // Cùng cấu hình mặc định với app: line dài nhất của frame đầu, sân từ 4 góc, line tracking theo Config
+    SessionOptions options;
+    options.courtCorners = synth.courtCorners();
+    options.courtModel = true;
+    AnalysisSession session(options);
+    session.begin(firstFrame);
+
+    Pipeline pipeline(Config::QUEUE_CAPACITY);
+    std::string eventsPath = cv::tempfile(".jsonl");
+    EventWriter events(eventsPath);
+
+    CountingMatAllocator matAllocator(cv::Mat::getStdAllocator());
+    cv::Mat::setDefaultAllocator(&matAllocator);
+
+    // Bật / tắt đếm theo frame ra khỏi track: luồng decode chạy trước vài frame,
+    // cũng đã qua warmup nên cấp phát của nó đều tính
+    long measured = 0;
+    cv::RNG rng(synthOptions.seed + 1);
+    std::vector<cv::Rect> fakes;
+    auto detectStage = [&](FramePacket& packet) {
+        SyntheticRally::BallTruth truth = synth.ball(packet.index);
+        if (truth.visible && rng.uniform(0.0f, 1.0f) >= Config::SYNTH_ORACLE_MISS) {
+            int side = std::max(4, cvRound(2.0f * truth.radius));
+            float cx = truth.imagePos.x + (float)rng.gaussian(Config::SYNTH_ORACLE_JITTER_PX);
+            float cy = truth.imagePos.y + (float)rng.gaussian(Config::SYNTH_ORACLE_JITTER_PX);
+            packet.detections.push_back({0, 0.9f, cv::Rect(cvRound(cx - side / 2.0f), cvRound(cy - side / 2.0f),
+                                                          side, side)});
+        }
+        synth.distractorBoxes(packet.index, fakes);
+        for (const cv::Rect& box : fakes) {
+            if (rng.uniform(0.0f, 1.0f) < Config::SYNTH_ORACLE_FALSE_RATE) packet.detections.push_back({0, 0.5f, box});
+        }
+    };
+    auto trackStage = [&](FramePacket& packet) {
+        if (packet.index == ALLOC_WARMUP) g_countAllocs = true;
+        session.track(packet.frame, packet.index, packet.detections, packet.track);
+        packet.hasCourtLine = session.hasCourtLine();
+        packet.courtLine = session.courtLine();
+        if (packet.index >= ALLOC_WARMUP && measured < ALLOC_MEASURED && ++measured == ALLOC_MEASURED) {
+            g_countAllocs = false;
+        }
+    };
+    auto encodeStage = [&](FramePacket& packet) {
+        events.write(packet.index, packet.timestampMs, packet.track);
+        Renderer::drawTrack(packet.frame, packet.track);
+        if (packet.hasCourtLine) Renderer::drawCourtLine(packet.frame, packet.courtLine, session.outRef());
+    };
+    long frames = pipeline.run(cap, detectStage, trackStage, encodeStage);
+    g_countAllocs = false;
+    cv::Mat::setDefaultAllocator(nullptr);
+    std::remove(videoPath.c_str());
+    std::remove(eventsPath.c_str());
+
+    if (measured < ALLOC_MEASURED) {
+        std::printf("alloc-test FAILED: only %ld of %ld frames measured (%ld decoded)\n",
+                    measured, ALLOC_MEASURED, frames);
+        return 1;
+    }
+    long heap = g_heapAllocs.load();
+    long mats = g_matAllocs.load();
+    std::printf("alloc-test: %ld frames after %ld warmup\n", measured, ALLOC_WARMUP);
+    std::printf("  operator new : %ld (%.3f / frame)\n", heap, (double)heap / measured);
+    std::printf("  cv::Mat      : %ld (%.3f / frame)\n", mats, (double)mats / measured);
+    bool ok = heap == 0 && mats == 0;
+    std::printf("alloc-test %s\n", ok ? "PASSED" : "FAILED");
+    return ok ? 0 : 1;
+}
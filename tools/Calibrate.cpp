@@ -0,0 +1,190 @@
+// Tạo frame calibration cho INT8 từ video của chính mình và so sánh FP16 / INT8 với FP32 trên cùng frame.
+// Frame được lấy đều trên toàn video: nửa làm calibration (ghi PNG vào --out, YoloDetector lượng tử từ đây
+// khi load với --precision int8), nửa còn lại làm tập đánh giá. Detection của FP32 là chuẩn: recall / precision
+// của mỗi chế độ tính theo ghép cặp IoU >= --iou với detection FP32 cùng class, kèm latency forward.
+//
+//   ./PickleballCalibrate --video data/In.mp4 [--video more.mp4] [--model data/model_ver2.onnx]
+//                         [--out data/calib] [--samples 64] [--eval 200] [--iou 0.5] [--report precision_report.csv]
+
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "Config.h"
+#include "YoloDetector.h"
+
+struct ModeResult {
+    Precision requested;
+    Precision active;
+    std::vector<double> forwardMs{};
+    long refBoxes = 0;      // Detection FP32
+    long testBoxes = 0;     // Detection của chế độ này
+    long matched = 0;
+    double centerErr = 0.0; // Tổng sai lệch tâm (pixel) của các cặp ghép được
+};
+
+static float iou(const cv::Rect& a, const cv::Rect& b) {
+    float inter = (float)(a & b).area();
+    float uni = (float)(a.area() + b.area()) - inter;
+    return uni > 0.0f ? inter / uni : 0.0f;
+}
+
+// Ghép tham lam theo IoU giảm dần, mỗi box chỉ ghép 1 lần
+static void compare(const std::vector<Detection>& ref, const std::vector<Detection>& test, float minIou,
+                    ModeResult& result) {
+    struct Pair { float iou; int r; int t; };
+    std::vector<Pair> pairs;
+    for (int r = 0; r < (int)ref.size(); ++r) {
+        for (int t = 0; t < (int)test.size(); ++t) {
+            if (ref[r].class_id != test[t].class_id) continue;
+            float v = iou(ref[r].box, test[t].box);
+            if (v >= minIou) pairs.push_back({v, r, t});
+        }
+    }
+    std::sort(pairs.begin(), pairs.end(), [](const Pair& a, const Pair& b) { return a.iou > b.iou; });
+    std::vector<bool> usedRef(ref.size(), false), usedTest(test.size(), false);
+    for (const auto& p : pairs) {
+        if (usedRef[p.r] || usedTest[p.t]) continue;
+        usedRef[p.r] = usedTest[p.t] = true;
+        ++result.matched;
+        cv::Point2f cr(ref[p.r].box.x + ref[p.r].box.width * 0.5f, ref[p.r].box.y + ref[p.r].box.height * 0.5f);
+        cv::Point2f ct(test[p.t].box.x + test[p.t].box.width * 0.5f, test[p.t].box.y + test[p.t].box.height * 0.5f);
+        result.centerErr += cv::norm(cr - ct);
+    }
+    result.refBoxes += (long)ref.size();
+    result.testBoxes += (long)test.size();
+}
+
+// Detect 1 frame với 3 bước tách riêng để chỉ đo thời gian forward
+static std::vector<Detection> runDetector(YoloDetector& detector, const cv::Mat& frame, std::vector<double>& forwardMs) {
+    cv::Mat blob;
+    YoloDetector::preprocess(frame, blob, 640);
+    auto t0 = std::chrono::steady_clock::now();
+    cv::Mat output = detector.forward(blob);
+    auto t1 = std::chrono::steady_clock::now();
+    forwardMs.push_back(std::chrono::duration<double, std::milli>(t1 - t0).count());
+    return detector.decode(output, cv::Rect(0, 0, frame.cols, frame.rows), 640);
+}
+
+static double percentile(std::vector<double> v, double q) {
+    if (v.empty()) return 0.0;
+    std::sort(v.begin(), v.end());
+    return v[std::min(v.size() - 1, (size_t)(q * v.size()))];
+}
+
+int main(int argc, char** argv) {
+    std::vector<std::string> videos;
+    std::string modelPath = Config::MODEL_PATH;
+    std::string outDir = Config::CALIBRATION_DIR;
+    std::string reportPath = "precision_report.csv";
+    int samples = Config::CALIBRATION_MAX_FRAMES;
+    int evalFrames = 200;
+    float minIou = 0.5f;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--video" && i + 1 < argc) videos.push_back(argv[++i]);
+        else if (arg == "--model" && i + 1 < argc) modelPath = argv[++i];
+        else if (arg == "--out" && i + 1 < argc) outDir = argv[++i];
+        else if (arg == "--samples" && i + 1 < argc) samples = std::atoi(argv[++i]);
+        else if (arg == "--eval" && i + 1 < argc) evalFrames = std::atoi(argv[++i]);
+        else if (arg == "--iou" && i + 1 < argc) minIou = (float)std::atof(argv[++i]);
+        else if (arg == "--report" && i + 1 < argc) reportPath = argv[++i];
+    }
+    if (videos.empty()) videos.push_back(Config::SOURCE_VIDEO_PATH);
+    samples = std::max(1, samples);
+    evalFrames = std::max(1, evalFrames);
+
+    // 1. Lấy frame đều trên mọi video, xen kẽ calibration / đánh giá để 2 tập không trùng frame
+    std::vector<cv::Mat> calibration, evaluation;
+    int perVideo = (samples + evalFrames + (int)videos.size() - 1) / (int)videos.size();
+    for (const auto& path : videos) {
+        cv::VideoCapture cap(path);
+        long total = cap.isOpened() ? (long)cap.get(cv::CAP_PROP_FRAME_COUNT) : 0;
+        if (total <= 0) {
+            std::fprintf(stderr, "Cannot read %s, skipped\n", path.c_str());
+            continue;
+        }
+        for (int k = 0; k < perVideo; ++k) {
+            cap.set(cv::CAP_PROP_POS_FRAMES, (double)(total * k / perVideo));
+            cv::Mat frame;
+            if (!cap.read(frame)) break;
+            bool calibFull = (int)calibration.size() >= samples;
+            bool evalFull = (int)evaluation.size() >= evalFrames;
+            if (!calibFull && (k % 2 == 0 || evalFull)) calibration.push_back(frame);
+            else if (!evalFull) evaluation.push_back(frame);
+        }
+    }
+    if (calibration.empty() || evaluation.empty()) {
+        std::fprintf(stderr, "Not enough frames sampled\n");
+        return 1;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(outDir, ec);
+    for (const auto& old : std::filesystem::directory_iterator(outDir, ec)) {
+        if (old.path().extension() == ".png") std::filesystem::remove(old.path(), ec);
+    }
+    char name[64];
+    for (size_t i = 0; i < calibration.size(); ++i) {
+        std::snprintf(name, sizeof(name), "/calib_%03zu.png", i);
+        cv::imwrite(outDir + name, calibration[i]);
+    }
+    std::printf("Wrote %zu calibration frames to %s, evaluating on %zu frames\n",
+                calibration.size(), outDir.c_str(), evaluation.size());
+
+    // 2. FP32 làm chuẩn, rồi từng chế độ giảm precision trên cùng tập frame
+    YoloDetector reference(modelPath, Precision::FP32, outDir);
+    ModeResult fp32{Precision::FP32, Precision::FP32};
+    std::vector<std::vector<Detection>> refDetections;
+    for (const auto& frame : evaluation) {
+        refDetections.push_back(runDetector(reference, frame, fp32.forwardMs));
+    }
+    for (const auto& dets : refDetections) {
+        fp32.refBoxes += (long)dets.size();
+        fp32.testBoxes += (long)dets.size();
+    }
+    fp32.matched = fp32.refBoxes;
+
+    std::vector<ModeResult> results{fp32};
+    for (Precision mode : {Precision::FP16, Precision::INT8}) {
+        YoloDetector detector(modelPath, mode, outDir);
+        ModeResult r{mode, detector.precision()};
+        if (r.active != mode) {
+            std::printf("%s not available on this machine, skipped\n", YoloDetector::precisionName(mode));
+            continue;
+        }
+        for (size_t i = 0; i < evaluation.size(); ++i) {
+            compare(refDetections[i], runDetector(detector, evaluation[i], r.forwardMs), minIou, r);
+        }
+        results.push_back(r);
+    }
+
+    // 3. Báo cáo
+    std::ofstream csv(reportPath);
+    csv << "precision,frames,forward_p50_ms,forward_p95_ms,speedup,recall,precision_vs_fp32,mean_center_err_px\n";
+    std::printf("%-6s %8s %10s %10s %8s %8s %10s %10s\n", "mode", "frames", "p50 ms", "p95 ms",
+                "speedup", "recall", "precision", "center px");
+    double baseP50 = percentile(results[0].forwardMs, 0.5);
+    for (const auto& r : results) {
+        double p50 = percentile(r.forwardMs, 0.5);
+        double p95 = percentile(r.forwardMs, 0.95);
+        double speedup = p50 > 0.0 ? baseP50 / p50 : 0.0;
+        double recall = r.refBoxes > 0 ? (double)r.matched / r.refBoxes : 1.0;
+        double prec = r.testBoxes > 0 ? (double)r.matched / r.testBoxes : 1.0;
+        double err = r.matched > 0 ? r.centerErr / r.matched : 0.0;
+        const char* mode = YoloDetector::precisionName(r.active);
+        std::printf("%-6s %8zu %10.2f %10.2f %7.2fx %8.3f %10.3f %10.2f\n", mode, r.forwardMs.size(),
+                    p50, p95, speedup, recall, prec, err);
+        char line[256];
+        std::snprintf(line, sizeof(line), "%s,%zu,%.3f,%.3f,%.3f,%.4f,%.4f,%.3f\n", mode, r.forwardMs.size(),
+                      p50, p95, speedup, recall, prec, err);
+        csv << line;
+    }
+    std::printf("Report written to %s\n", reportPath.c_str());
+    return 0;
+}
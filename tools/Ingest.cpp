@@ -0,0 +1,103 @@
+// Ingest nhiều clip ngắn trong 1 process qua AnalysisSession: model được load + warm 1 lần trong ModelPool,
+// mỗi worker lấy clip kế tiếp, mở 1 session (mượn detector đã warm), đẩy mọi frame rồi ghi event của clip
+// ra <clip>.events.jsonl cạnh file clip. In thời gian từng clip và throughput (clip / giờ).
+//
+//   ./PickleballIngest [--workers 4] [--model data/model_ver2.onnx] [--precision fp32|fp16|int8]
+//                      [--court] [--tiled] clip1.mp4 clip2.mp4 ...
+
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Config.h"
+#include "AnalysisSession.h"
+#include "EventWriter.h"
+
+// "clips/a.mp4" -> "clips/a.events.jsonl"
+static std::string eventsPathFor(const std::string& clip) {
+    size_t slash = clip.find_last_of("/\\");
+    size_t dot = clip.find_last_of('.');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) return clip + ".events.jsonl";
+    return clip.substr(0, dot) + ".events.jsonl";
+}
+
+int main(int argc, char** argv) {
+    std::string modelPath = Config::MODEL_PATH;
+    std::string precisionName = Config::INFERENCE_PRECISION;
+    int workers = 4;
+    SessionOptions options;
+    std::vector<std::string> clips;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--workers" && i + 1 < argc) workers = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--model" && i + 1 < argc) modelPath = argv[++i];
+        else if (arg == "--precision" && i + 1 < argc) precisionName = argv[++i];
+        else if (arg == "--court") options.courtModel = true;
+        else if (arg == "--tiled") options.tiled = true;
+        else clips.push_back(arg);
+    }
+    if (clips.empty()) {
+        std::printf("Usage: %s [--workers N] [--model path] [--precision p] [--court] [--tiled] clip...\n", argv[0]);
+        return 1;
+    }
+    Precision precision;
+    if (!YoloDetector::parsePrecision(precisionName, precision)) {
+        std::printf("--precision expects fp32, fp16 or int8\n");
+        return 1;
+    }
+
+    workers = std::min<int>(workers, (int)clips.size());
+    int cores = (int)std::thread::hardware_concurrency();
+    cv::setNumThreads(std::max(1, cores / workers));
+
+    auto t0 = std::chrono::steady_clock::now();
+    ModelPool models(modelPath, workers, precision);
+    double loadSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    std::printf("Loaded and warmed %d detectors (%s) in %.2f s\n", models.size(),
+                YoloDetector::precisionName(precision), loadSec);
+
+    std::atomic<size_t> next(0);
+    std::atomic<long> totalFrames(0);
+    std::atomic<int> failed(0);
+    std::mutex printMtx;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (int w = 0; w < workers; ++w) {
+        pool.emplace_back([&]() {
+            cv::Mat frame;
+            for (size_t i = next++; i < clips.size(); i = next++) {
+                auto clipStart = std::chrono::steady_clock::now();
+                cv::VideoCapture cap(clips[i]);
+                if (!cap.isOpened()) {
+                    ++failed;
+                    std::lock_guard<std::mutex> lock(printMtx);
+                    std::printf("%-40s cannot open\n", clips[i].c_str());
+                    continue;
+                }
+                EventWriter events(eventsPathFor(clips[i]));
+                AnalysisSession session(models, options);
+                session.onEvent([&](const SessionEvent& e) { events.write(e.frameIndex, e.timestampMs, e.track); });
+                while (cap.read(frame)) session.push(frame, cap.get(cv::CAP_PROP_POS_MSEC));
+                totalFrames += session.frames();
+
+                double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - clipStart).count();
+                std::lock_guard<std::mutex> lock(printMtx);
+                std::printf("%-40s %6ld frames %6ld events %8.2f s %8.1f fps\n", clips[i].c_str(), session.frames(),
+                            session.events(), sec, sec > 0.0 ? session.frames() / sec : 0.0);
+            }
+        });
+    }
+    for (auto& t : pool) t.join();
+
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    size_t done = clips.size() - failed;
+    std::printf("%zu clips, %ld frames in %.2f s: %.1f fps, %.0f clips/hour\n", done, totalFrames.load(), sec,
+                sec > 0.0 ? totalFrames / sec : 0.0, sec > 0.0 ? done * 3600.0 / sec : 0.0);
+    return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,85 @@
+// Replay nhiều trace detection (.pbtrace, ghi bằng --record-trace) qua BallTracker + processBounce,
+// không decode video, không chạy model: dùng để quét thay đổi ngưỡng tracker trên cả mùa giải.
+// Mỗi worker lấy trace kế tiếp, ghi event ra <trace>.events.jsonl cạnh file trace (--no-events: chỉ đếm),
+// in số bounce IN / OUT của từng trace và throughput (frame / giây).
+//
+//   ./PickleballReplay [--workers 8] [--no-events] season/*.pbtrace
+
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "DetectionTrace.h"
+#include "EventWriter.h"
+
+int main(int argc, char** argv) {
+    int workers = (int)std::max(1u, std::thread::hardware_concurrency());
+    bool writeEvents = true;
+    std::vector<std::string> traces;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--workers" && i + 1 < argc) workers = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--no-events") writeEvents = false;
+        else traces.push_back(arg);
+    }
+    if (traces.empty()) {
+        std::printf("Usage: %s [--workers N] [--no-events] trace.pbtrace...\n", argv[0]);
+        return 1;
+    }
+    workers = std::min<int>(workers, (int)traces.size());
+    cv::setNumThreads(1); // Song song theo trace, không theo pixel
+
+    std::atomic<size_t> next(0);
+    std::atomic<long> totalFrames(0);
+    std::atomic<long> totalBounces(0);
+    std::atomic<int> failed(0);
+    std::mutex printMtx;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (int w = 0; w < workers; ++w) {
+        pool.emplace_back([&]() {
+            for (size_t i = next++; i < traces.size(); i = next++) {
+                TraceReader trace;
+                if (!trace.open(traces[i])) {
+                    ++failed;
+                    std::lock_guard<std::mutex> lock(printMtx);
+                    std::printf("%-40s cannot open\n", traces[i].c_str());
+                    continue;
+                }
+                std::unique_ptr<EventWriter> events;
+                if (writeEvents) events.reset(new EventWriter(DetectionTrace::eventsPathFor(traces[i])));
+
+                long in = 0, out = 0;
+                auto traceStart = std::chrono::steady_clock::now();
+                long frames = DetectionTrace::replay(trace, [&](long frameIndex, double timestampMs,
+                                                                const TrackResult& result) {
+                    if (result.bounceDetected) {
+                        if (result.verdict == "OUT") ++out;
+                        else ++in;
+                    }
+                    if (events) events->write(frameIndex, timestampMs, result);
+                });
+                double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - traceStart).count();
+                totalFrames += frames;
+                totalBounces += in + out;
+
+                std::lock_guard<std::mutex> lock(printMtx);
+                std::printf("%-40s %8ld frames %5ld IN %5ld OUT %8.3f s %10.0f fps\n", traces[i].c_str(), frames,
+                            in, out, sec, sec > 0.0 ? frames / sec : 0.0);
+            }
+        });
+    }
+    for (auto& t : pool) t.join();
+
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("%zu traces, %ld frames, %ld bounces in %.2f s: %.0f fps\n", traces.size() - failed,
+                totalFrames.load(), totalBounces.load(), sec, sec > 0.0 ? totalFrames / sec : 0.0);
+    return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,325 @@
+// Benchmark độ chính xác theo throughput trên video tổng hợp có ground truth (SyntheticRally):
+// sinh frame, chạy detect rồi AnalysisSession::track (bước lõi của app: tracker -> line tracking -> IN/OUT)
+// như luồng in-order của app, in fps cạnh precision / recall
+// của bounce, sai số điểm chạm, sai số thời điểm chạm và độ chính xác IN/OUT. Chỉ thời gian pipeline được tính
+// vào fps (không tính thời gian vẽ frame). Mỗi tối ưu tốc độ đi kèm cái giá về độ chính xác của nó:
+//
+//   ./PickleballSynth [--width 1920 --height 1080 --fps 60 --seconds 60 --seed 1 --distractors 4 --no-shadows]
+//                     [--model data/model_ver2.onnx] [--precision fp32|fp16|int8]
+//                     [--input-size 640] [--skip N] [--roi] [--tiled] [--truth-corners] [--csv report.csv]
+//   ./PickleballSynth --oracle ...          # Không cần model: detection = ground truth + nhiễu + detection giả
+//   ./PickleballSynth --write synth.mp4     # Ghi video + synth.truth.jsonl để chạy chính app Pickleball
+//   ./PickleballSynth --score events.jsonl  # Chấm events.jsonl của lần chạy đó (cùng tham số sinh)
+
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Config.h"
+#include "SyntheticRally.h"
+#include "ModelPool.h"
+#include "AnalysisSession.h"
+#include "RoiScheduler.h"
+
+// Thống kê bám bóng chính theo từng frame (ngoài bounce)
+struct BallStats {
+    long visible = 0;     // Frame có bóng thật trong khung hình
+    long reported = 0;    // Frame pipeline báo có bóng chính
+    long hits = 0;        // Báo có bóng và đúng vị trí bóng thật
+
+    void add(const SyntheticRally::BallTruth& truth, bool hasBall, cv::Point2f pos) {
+        if (truth.visible) ++visible;
+        if (!hasBall) return;
+        ++reported;
+        float tolerance = std::max(8.0f, 3.0f * truth.radius);
+        if (truth.visible && cv::norm(pos - truth.imagePos) <= tolerance) ++hits;
+    }
+};
+
+static bool fileExists(const std::string& path) {
+    std::ifstream f(path);
+    return f.good();
+}
+
+// "out/synth.mp4" -> "out/synth.truth.jsonl"
+static std::string truthPathFor(const std::string& video) {
+    size_t slash = video.find_last_of("/\\");
+    size_t dot = video.find_last_of('.');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) return video + ".truth.jsonl";
+    return video.substr(0, dot) + ".truth.jsonl";
+}
+
+// Số ngay sau key (vd. "\"frame\":") trong 1 dòng JSON của EventWriter
+static bool numberAfter(const std::string& line, const char* key, size_t from, double& out) {
+    size_t pos = line.find(key, from);
+    if (pos == std::string::npos) return false;
+    const char* start = line.c_str() + pos + std::strlen(key);
+    char* end = nullptr;
+    out = std::strtod(start, &end);
+    return end != start;
+}
+
+// Đọc events.jsonl của app: bounce (kèm điểm chạm, verdict, toạ độ sân) và vị trí bóng chính từng frame
+static bool readEvents(const std::string& path, const SyntheticRally& synth,
+                       std::vector<SyntheticRally::BounceCall>& calls, BallStats& ball) {
+    std::ifstream in(path);
+    if (!in.is_open()) return false;
+    std::vector<cv::Point2f> ballAt(synth.frames());
+    std::vector<bool> hasBall(synth.frames(), false);
+    std::string line;
+    while (std::getline(in, line)) {
+        double frame;
+        if (!numberAfter(line, "\"frame\":", 0, frame)) continue;
+        long index = (long)frame;
+        double x, y;
+        size_t ballPos = line.find("\"ball\":[");
+        if (ballPos != std::string::npos && index >= 0 && index < synth.frames() &&
+            numberAfter(line, "[", ballPos, x) && numberAfter(line, ",", line.find('[', ballPos), y)) {
+            hasBall[index] = true;
+            ballAt[index] = cv::Point2f((float)x, (float)y);
+        }
+
+        size_t bounce = line.find("\"bounce\":{");
+        if (bounce == std::string::npos) continue;
+        SyntheticRally::BounceCall call;
+        call.frame = frame;
+        double exact;
+        if (numberAfter(line, "\"frame_exact\":", bounce, exact)) call.frame = exact;
+        if (numberAfter(line, "\"x\":", bounce, x) && numberAfter(line, "\"y\":", bounce, y)) {
+            call.hasPoint = true;
+            call.imagePos = cv::Point2f((float)x, (float)y);
+        }
+        size_t court = line.find("\"court_m\":[", bounce);
+        if (court != std::string::npos && numberAfter(line, "[", court, x) &&
+            numberAfter(line, ",", line.find('[', court), y)) {
+            call.hasCourtPos = true;
+            call.courtPos = cv::Point2f((float)x, (float)y);
+        }
+        size_t verdict = line.find("\"verdict\":\"", bounce);
+        if (verdict != std::string::npos) {
+            size_t start = verdict + std::strlen("\"verdict\":\"");
+            call.verdict = line.substr(start, line.find('"', start) - start);
+        }
+        calls.push_back(call);
+    }
+    for (long i = 0; i < synth.frames(); ++i) ball.add(synth.ball(i), hasBall[i], ballAt[i]);
+    return true;
+}
+
+static void printScore(const SyntheticRally& synth, const SyntheticRally::Score& s, const BallStats& ball) {
+    std::printf("ball            recall %.3f  precision %.3f\n",
+                ball.visible > 0 ? (double)ball.hits / ball.visible : 0.0,
+                ball.reported > 0 ? (double)ball.hits / ball.reported : 0.0);
+    std::printf("bounce          precision %.3f  recall %.3f  (%d / %d truth, %d calls)\n", s.precision, s.recall,
+                s.matched, s.truthBounces, s.calls);
+    std::printf("contact point   mean %.1f px  p95 %.1f px  mean %.3f m\n", s.contactErrorPx, s.contactErrorPxP95,
+                s.contactErrorM);
+    std::printf("timing          mean %.2f frames (%.1f ms)\n", s.timingErrorFrames,
+                s.timingErrorFrames * 1000.0 / synth.options().fps);
+    std::printf("calls           accuracy %.3f (%d / %d)  IN->OUT %d  OUT->IN %d\n", s.callAccuracy, s.correctCalls,
+                s.matched, s.inCalledOut, s.outCalledIn);
+}
+
+int main(int argc, char** argv) {
+    SyntheticRally::Options options;
+    std::string modelPath = Config::MODEL_PATH;
+    std::string precisionName = Config::INFERENCE_PRECISION;
+    std::string writePath, scorePath, csvPath;
+    bool oracle = false, roi = false, tiled = false, truthCorners = false;
+    int inputSize = 640;
+    int skip = 1;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--width" && i + 1 < argc) options.frameSize.width = std::atoi(argv[++i]);
+        else if (arg == "--height" && i + 1 < argc) options.frameSize.height = std::atoi(argv[++i]);
+        else if (arg == "--fps" && i + 1 < argc) options.fps = std::atof(argv[++i]);
+        else if (arg == "--seconds" && i + 1 < argc) options.seconds = std::atof(argv[++i]);
+        else if (arg == "--seed" && i + 1 < argc) options.seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--distractors" && i + 1 < argc) options.distractors = std::atoi(argv[++i]);
+        else if (arg == "--no-shadows") options.shadows = false;
+        else if (arg == "--model" && i + 1 < argc) modelPath = argv[++i];
+        else if (arg == "--precision" && i + 1 < argc) precisionName = argv[++i];
+        else if (arg == "--input-size" && i + 1 < argc) inputSize = std::atoi(argv[++i]);
+        else if (arg == "--skip" && i + 1 < argc) skip = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--roi") roi = true;
+        else if (arg == "--tiled") tiled = true;
+        else if (arg == "--truth-corners") truthCorners = true;
+        else if (arg == "--oracle") oracle = true;
+        else if (arg == "--write" && i + 1 < argc) writePath = argv[++i];
+        else if (arg == "--score" && i + 1 < argc) scorePath = argv[++i];
+        else if (arg == "--csv" && i + 1 < argc) csvPath = argv[++i];
+    }
+
+    SyntheticRally synth(options);
+    int truthIn = 0;
+    for (const auto& b : synth.bounces()) truthIn += b.in ? 1 : 0;
+    std::printf("synthetic %dx%d @ %.0f fps, %ld frames, %zu bounces (%d IN / %zu OUT), seed %llu\n",
+                options.frameSize.width, options.frameSize.height, options.fps, synth.frames(),
+                synth.bounces().size(), truthIn, synth.bounces().size() - truthIn,
+                (unsigned long long)options.seed);
+    const std::vector<cv::Point2f>& corners = synth.courtCorners();
+
+    // Ghi video + ground truth để chạy chính app (mọi mode của app: --adaptive, --motion-gate, ...)
+    if (!writePath.empty()) {
+        cv::VideoWriter writer(writePath, cv::VideoWriter::fourcc('m', 'p', '4', 'v'), options.fps, options.frameSize);
+        if (!writer.isOpened()) {
+            std::printf("Cannot write %s\n", writePath.c_str());
+            return 1;
+        }
+        cv::Mat frame;
+        for (long i = 0; i < synth.frames(); ++i) {
+            synth.render(i, frame);
+            writer.write(frame);
+        }
+        writer.release();
+        std::string truthPath = truthPathFor(writePath);
+        synth.writeTruth(truthPath);
+        std::printf("Wrote %s and %s\n", writePath.c_str(), truthPath.c_str());
+        std::printf("Court corners: --court-corners %.0f,%.0f,%.0f,%.0f,%.0f,%.0f,%.0f,%.0f\n", corners[0].x,
+                    corners[0].y, corners[1].x, corners[1].y, corners[2].x, corners[2].y, corners[3].x, corners[3].y);
+        return 0;
+    }
+
+    // Chấm events.jsonl của app trên video đã ghi bằng --write (cùng tham số sinh -> cùng ground truth)
+    if (!scorePath.empty()) {
+        std::vector<SyntheticRally::BounceCall> calls;
+        BallStats ball;
+        if (!readEvents(scorePath, synth, calls, ball)) {
+            std::printf("Cannot read %s\n", scorePath.c_str());
+            return 1;
+        }
+        printScore(synth, synth.score(calls), ball);
+        return 0;
+    }
+
+    Precision precision;
+    if (!YoloDetector::parsePrecision(precisionName, precision)) {
+        std::printf("--precision expects fp32, fp16 or int8\n");
+        return 1;
+    }
+    if (!oracle && !fileExists(modelPath)) {
+        std::printf("Model not found: %s (use --oracle to run the tracker on noisy ground-truth detections)\n",
+                    modelPath.c_str());
+        return 1;
+    }
+    std::unique_ptr<ModelPool> models;
+    ModelPool::Lease detector;
+    if (!oracle) {
+        models.reset(new ModelPool(modelPath, 1, precision));
+        detector = models->acquire();
+    }
+
+    // Session như app --court --headless: line dài nhất của frame đầu, mô hình sân fit từ line (hoặc góc thật
+    // với --truth-corners), line tracking theo Config. Fit từ line thất bại -> session mới với góc thật.
+    cv::Mat frame;
+    synth.render(0, frame);
+    SessionOptions sessionOptions;
+    sessionOptions.courtModel = true;
+    sessionOptions.tiled = tiled;
+    if (truthCorners) sessionOptions.courtCorners = corners;
+    std::unique_ptr<AnalysisSession> session(new AnalysisSession(sessionOptions));
+    session->begin(frame);
+    bool fromLines = !truthCorners && session->court().valid();
+    if (!truthCorners && !fromLines) {
+        sessionOptions.courtCorners = corners;
+        session.reset(new AnalysisSession(sessionOptions));
+        session->begin(frame);
+    }
+    const std::vector<cv::Rect>& tiles = session->tiles();
+    std::printf("court           %s\n", fromLines ? "calibrated from detected lines"
+                                                  : (truthCorners ? "ground-truth corners"
+                                                                  : "line calibration failed, ground-truth corners"));
+    std::printf("mode            %s, input %d, skip %d, roi %s, tiled %s (%zu tiles)\n",
+                oracle ? "oracle" : YoloDetector::precisionName(precision), inputSize, skip, roi ? "on" : "off",
+                tiled ? "on" : "off", tiles.size());
+
+    BallTracker& tracker = session->ballTracker();
+    RoiScheduler roiScheduler;
+    TrackResult result;
+    std::vector<Detection> detections;
+    std::vector<cv::Rect> fakes;
+    std::vector<SyntheticRally::BounceCall> calls;
+    BallStats ball;
+    cv::RNG rng(options.seed + 1);
+    const cv::Rect full(cv::Point(0, 0), options.frameSize);
+    double pipelineSec = 0.0;
+    long detectorFrames = 0;
+    for (long i = 0; i < synth.frames(); ++i) {
+        if (i > 0) synth.render(i, frame);
+        SyntheticRally::BallTruth truth = synth.ball(i);
+
+        // Detection giả lập của oracle sinh trước khi bấm giờ: không phải chi phí của pipeline
+        if (oracle) {
+            detections.clear();
+            if (truth.visible && rng.uniform(0.0f, 1.0f) >= Config::SYNTH_ORACLE_MISS) {
+                int side = std::max(4, cvRound(2.0f * truth.radius));
+                float cx = truth.imagePos.x + (float)rng.gaussian(Config::SYNTH_ORACLE_JITTER_PX);
+                float cy = truth.imagePos.y + (float)rng.gaussian(Config::SYNTH_ORACLE_JITTER_PX);
+                detections.push_back({0, 0.9f, cv::Rect(cvRound(cx - side / 2.0f), cvRound(cy - side / 2.0f),
+                                                       side, side)});
+            }
+            synth.distractorBoxes(i, fakes);
+            for (const cv::Rect& box : fakes) {
+                if (rng.uniform(0.0f, 1.0f) < Config::SYNTH_ORACLE_FALSE_RATE) detections.push_back({0, 0.5f, box});
+            }
+        }
+
+        auto t0 = std::chrono::steady_clock::now();
+        if (!oracle) {
+            detections.clear();
+            if (i % skip == 0) {
+                ++detectorFrames;
+                if (roi) roiScheduler.detect(*detector, frame, i, tracker, detections);
+                else if (!tiles.empty()) detector->detectTiles(frame, tiles, detections);
+                else if (inputSize != 640) detector->detectRoi(frame, full, inputSize, detections);
+                else detector->detect(frame, detections);
+            }
+        }
+        session->track(frame, i, detections, result);
+        pipelineSec += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+        ball.add(truth, result.hasBall, result.ballPos);
+        if (result.bounceDetected) {
+            SyntheticRally::BounceCall call;
+            call.frame = i + result.bounceFrameOffset;
+            call.hasPoint = result.hasBouncePoint;
+            call.imagePos = result.bouncePoint;
+            call.hasCourtPos = result.hasCourtPos;
+            call.courtPos = result.courtPos;
+            call.verdict = result.verdict;
+            calls.push_back(call);
+        }
+    }
+
+    double fps = pipelineSec > 0.0 ? synth.frames() / pipelineSec : 0.0;
+    std::printf("pipeline        %ld frames (%ld detector)  %.2f s  %.1f fps\n", synth.frames(),
+                oracle ? 0L : detectorFrames, pipelineSec, fps);
+    SyntheticRally::Score s = synth.score(calls);
+    printScore(synth, s, ball);
+
+    // 1 dòng mỗi lần chạy để so sánh các cấu hình
+    if (!csvPath.empty()) {
+        bool header = !fileExists(csvPath);
+        std::ofstream csv(csvPath, std::ios::app);
+        if (header) {
+            csv << "width,height,fps_video,seed,mode,input,skip,roi,tiled,fps,ball_recall,bounce_precision,"
+                   "bounce_recall,contact_px,contact_px_p95,contact_m,timing_frames,call_accuracy\n";
+        }
+        char buf[512];
+        std::snprintf(buf, sizeof(buf), "%d,%d,%.0f,%llu,%s,%d,%d,%d,%d,%.1f,%.4f,%.4f,%.4f,%.2f,%.2f,%.4f,%.3f,%.4f\n",
+                      options.frameSize.width, options.frameSize.height, options.fps,
+                      (unsigned long long)options.seed, oracle ? "oracle" : YoloDetector::precisionName(precision),
+                      inputSize, skip, roi ? 1 : 0, tiled ? 1 : 0, fps,
+                      ball.visible > 0 ? (double)ball.hits / ball.visible : 0.0, s.precision, s.recall,
+                      s.contactErrorPx, s.contactErrorPxP95, s.contactErrorM, s.timingErrorFrames, s.callAccuracy);
+        csv << buf;
+        std::printf("Appended to %s\n", csvPath.c_str());
+    }
+    return 0;
+}